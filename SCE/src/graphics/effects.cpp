@@ -0,0 +1,116 @@
+// (C) Stipl3x 2020
+
+#include "effects.hpp"
+
+namespace SCE { namespace graphics {
+
+    EffectScheduler::EffectScheduler() : m_nextEffectId(1) { }
+    EffectScheduler::~EffectScheduler() { }
+
+    //********************************************************************************
+
+    bool EffectScheduler::hasEffects() const { return !m_effects.empty(); }
+
+    //********************************************************************************
+
+    int EffectScheduler::schedule(EffectType t_type, int t_line, const std::string& t_text, double t_durationMs, double t_nowMs)
+    {
+        TimedEffect effect = { m_nextEffectId++, t_type, t_line, t_text, t_nowMs, t_durationMs };
+        m_effects.push_back(effect);
+
+        return effect.id;
+    }
+
+    void EffectScheduler::cancel(int t_effectId)
+    {
+        for (std::size_t effectIndex = 0; effectIndex < m_effects.size(); effectIndex++)
+        {
+            if (m_effects[effectIndex].id == t_effectId)
+            {
+                m_effects.erase(m_effects.begin() + effectIndex);
+                return;
+            }
+        }
+
+        return;
+    }
+
+    void EffectScheduler::cancelAll()
+    {
+        m_effects.clear();
+
+        return;
+    }
+
+    // Removes the effects that are over, returns true if any was playing
+    bool EffectScheduler::advance(double t_nowMs)
+    {
+        bool b_wasPlaying = !m_effects.empty();
+
+        std::size_t keptIndex = 0;
+        for (std::size_t effectIndex = 0; effectIndex < m_effects.size(); effectIndex++)
+        {
+            if (t_nowMs - m_effects[effectIndex].startMs < m_effects[effectIndex].durationMs)
+            {
+                m_effects[keptIndex++] = m_effects[effectIndex];
+            }
+        }
+        m_effects.resize(keptIndex);
+
+        return b_wasPlaying;
+    }
+
+    //********************************************************************************
+
+    void EffectScheduler::compose(char* t_frame, int t_width, int t_height, double t_nowMs) const
+    {
+        constexpr double BLINK_MS = 250.0;
+
+        for (const TimedEffect& effect : m_effects)
+        {
+            if (effect.line < 0 || effect.line >= t_height)
+            {
+                continue;
+            }
+
+            char* line = t_frame + effect.line * t_width;
+            int textLength = static_cast<int>(effect.text.size());
+            double elapsedMs = t_nowMs - effect.startMs;
+
+            switch (effect.type)
+            {
+            case EffectType::LINE_CLEAR:
+            {
+                // The text holds the blocks inside the borders, the ones on the left go first.
+                // Wiped blocks show what the frame already holds, the rows above moved down there.
+                int wipedBlocks = static_cast<int>(elapsedMs / effect.durationMs * textLength);
+                for (int textIndex = wipedBlocks; textIndex < textLength && textIndex + 1 < t_width - 1; textIndex++)
+                {
+                    line[textIndex + 1] = effect.text[textIndex];
+                }
+                break;
+            }
+
+            case EffectType::BANNER:
+            {
+                // Visible on even blinks only
+                if (static_cast<int>(elapsedMs / BLINK_MS) % 2 == 0)
+                {
+                    int firstColumn = (t_width - textLength) / 2;
+                    for (int textIndex = 0; textIndex < textLength; textIndex++)
+                    {
+                        if (firstColumn + textIndex >= 0 && firstColumn + textIndex < t_width)
+                        {
+                            line[firstColumn + textIndex] = effect.text[textIndex];
+                        }
+                    }
+                }
+                break;
+            }
+            }
+        }
+
+        return;
+    }
+
+} }
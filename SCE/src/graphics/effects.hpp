@@ -0,0 +1,68 @@
+#pragma once
+
+// (C) Stipl3x 2020
+
+/*
+ * The EffectScheduler class keeps the timed visual effects of a game,
+ * like the wipe of a cleared line or a blinking message. An effect never
+ * waits: it only knows when it started and how long it lasts, and every
+ * time a frame is composed it draws the step matching the current time
+ * over a copy of the game instance. The game state is already resolved
+ * when an effect starts, so the game keeps running while it plays out.
+ * Times are in milliseconds on the clock of the owner.
+ *
+ * GNU GPLv3
+ * (C) Stipl3x 2020
+ *
+ */
+
+#include <string>
+#include <vector>
+
+namespace SCE { namespace graphics {
+
+    enum class EffectType
+    {
+        LINE_CLEAR, // The blocks of the line are wiped from left to right
+        BANNER      // The text blinks in the middle of the line
+    };
+
+    struct TimedEffect
+    {
+        int id;
+        EffectType type;
+        int line;
+        std::string text;
+        double startMs;
+        double durationMs;
+    };
+
+    class EffectScheduler
+    {
+    public:
+        EffectScheduler(); // Constructor
+        ~EffectScheduler(); // Destructor
+
+        //*****Public Methods*****
+        // Getters
+        bool hasEffects() const;
+
+        // Effect lifetime, the id returned by schedule is used to cancel it
+        int schedule(EffectType t_type, int t_line, const std::string& t_text, double t_durationMs, double t_nowMs);
+        void cancel(int t_effectId);
+        void cancelAll();
+        bool advance(double t_nowMs);
+
+        // Draws every effect over the frame, which uses the game instance indexing
+        void compose(char* t_frame, int t_width, int t_height, double t_nowMs) const;
+
+
+
+        //*****Only hidden class stuff*****
+    private:
+        //*****Private Variables*****
+        std::vector<TimedEffect> m_effects;
+        int m_nextEffectId;
+    };
+
+} }
@@ -2,14 +2,33 @@
 
 #include "graphics.hpp"
 
+#include <cmath>
+
 namespace SCE { namespace graphics {
 
-    ConsoleEngine::ConsoleEngine() { reset(); }
+    ConsoleEngine::ConsoleEngine()
+        : m_gameInstance(nullptr), m_screenShadow(nullptr), m_frameBuffer(nullptr), m_terminal(nullptr), m_isHeadless(false),
+          m_frameBytes(0), m_frameCursorMoves(0), m_lastFrameBytes(0), m_lastFrameCursorMoves(0), m_input(nullptr),
+          m_clockStart(std::chrono::steady_clock::now()), m_isManualClock(false), m_manualClockMs(0.0)
+    {
+        reset();
+    }
     ConsoleEngine::~ConsoleEngine() { }
 
     //********************************************************************************
 
     int ConsoleEngine::getMyScore() const { return m_score; }
+    int ConsoleEngine::getMyLines() const { return m_lines; }
+    int ConsoleEngine::getLastFrameBytes() const { return m_lastFrameBytes; }
+    int ConsoleEngine::getLastFrameCursorMoves() const { return m_lastFrameCursorMoves; }
+    int ConsoleEngine::getDroppedFrames() const { return m_droppedFrames; }
+    int ConsoleEngine::getFrameCount() const { return m_frameCount; }
+    int ConsoleEngine::getPeakFrameBytes() const { return m_peakFrameBytes; }
+    int ConsoleEngine::getPeakFrameCursorMoves() const { return m_peakFrameCursorMoves; }
+    bool ConsoleEngine::isMinimalUpdateMode() const { return m_isMinimalUpdateMode; }
+    bool ConsoleEngine::isHeadless() const { return m_isHeadless; }
+    bool ConsoleEngine::hasEffects() const { return m_effects.hasEffects(); }
+    double ConsoleEngine::getTimeMs() const { return this_nowMs(); }
 
     //********************************************************************************
 
@@ -36,7 +55,42 @@ namespace SCE { namespace graphics {
         }
         m_gameInstance = nullptr;
 
+        if (m_screenShadow != nullptr)
+        {
+            delete[] m_screenShadow;
+        }
+        m_screenShadow = nullptr;
+
+        // The texts next to the game instance are unknown as well
+        this_invalidateShadow();
+
+        if (m_frameBuffer != nullptr)
+        {
+            delete[] m_frameBuffer;
+        }
+        m_frameBuffer = nullptr;
+
         m_score = 0;
+        m_lines = 0;
+
+        // Effects of the last game are not needed anymore
+        m_effects.cancelAll();
+
+        // Frame statistics are per game
+        m_frameCount = 0;
+        m_peakFrameBytes = 0;
+        m_peakFrameCursorMoves = 0;
+
+        // Start the pacing from scratch, as if the console was fast
+        m_frameStartMs = this_nowMs();
+        m_lastFrameStartMs = m_frameStartMs;
+        m_renderCostMs = 0.0;
+        m_bytesPerMs = 0.0;
+        m_minFrameIntervalMs = 0.0;
+        m_droppedFrames = 0;
+        m_isFramePending = false;
+        m_isFrameRefused = false;
+        m_isMinimalUpdateMode = false;
 
         moveCursorTo(0, 0);
     }
@@ -82,19 +136,44 @@ namespace SCE { namespace graphics {
             }
         }
 
+        // Nothing is known about the console yet
+        m_screenShadow = new char[m_width * m_height];
+        this_invalidateShadow();
+
+        m_frameBuffer = new char[m_width * m_height];
+
         return;
     }
 
     void ConsoleEngine::renderGameScreen()
     {
-        // Print the playground
+        if (m_isHeadless)
+        {
+            return;
+        }
+
+        // Draw the effects over a copy, the game instance is already up to date
+        const char* frame = m_gameInstance;
+        if (m_effects.hasEffects())
+        {
+            for (int index = 0; index < m_width * m_height; index++)
+            {
+                m_frameBuffer[index] = m_gameInstance[index];
+            }
+            m_effects.compose(m_frameBuffer, m_width, m_height, this_nowMs());
+            frame = m_frameBuffer;
+        }
+
+        // Print the playground, or only what changed on it when the console can't keep up
         for (int heightIndex = 0; heightIndex < m_height; heightIndex++)
         {
-            for (int widthIndex = 0; widthIndex < m_width; widthIndex++)
+            if (m_isMinimalUpdateMode)
             {
-                // Add paddings to the indexes to move the game position on console
-                moveCursorTo(widthIndex + m_widthPadding, heightIndex + m_heightPadding);
-                SCE_CONSOLE_OUTPUT << m_gameInstance[heightIndex * m_width + widthIndex];
+                this_printChangesOnLine(frame, heightIndex);
+            }
+            else
+            {
+                this_printLine(frame, heightIndex);
             }
         }
 
@@ -109,16 +188,29 @@ namespace SCE { namespace graphics {
 
     void ConsoleEngine::renderGameObject(char* t_currentGameObject, int t_width, int t_height, int t_currentXPosition, int t_currentYPosition)
     {
+        if (m_isHeadless)
+        {
+            return;
+        }
+
         for (int heightIndex = 0; heightIndex < t_height; heightIndex++)
         {
             for (int widthIndex = 0; widthIndex < t_width; widthIndex++)
             {
                 // Render only blocks that have font on them
-                if (t_currentGameObject[heightIndex * t_height + widthIndex] != m_emptyFont)
+                if (t_currentGameObject[heightIndex * t_width + widthIndex] != m_emptyFont)
                 {
-                    moveCursorTo(m_widthPadding + t_currentXPosition + widthIndex,
-                        m_heightPadding + t_currentYPosition + heightIndex);
-                    SCE_CONSOLE_OUTPUT << t_currentGameObject[heightIndex * t_width + widthIndex];
+                    int boardX = t_currentXPosition + widthIndex;
+                    int boardY = t_currentYPosition + heightIndex;
+
+                    moveCursorTo(m_widthPadding + boardX, m_heightPadding + boardY);
+                    this_print(t_currentGameObject[heightIndex * t_width + widthIndex]);
+
+                    // The object covers the board, so remember it for the next screen update
+                    if (boardX >= 0 && boardX < m_width && boardY >= 0 && boardY < m_height)
+                    {
+                        m_screenShadow[boardY * m_width + boardX] = t_currentGameObject[heightIndex * t_width + widthIndex];
+                    }
                 }
             }
         }
@@ -129,21 +221,161 @@ namespace SCE { namespace graphics {
     // Made it because it renders outside the game board
     void ConsoleEngine::displayFutureGameObject(char* t_futureGameObject, int t_width, int t_height)
     {
-        moveCursorTo(2 * m_widthPadding + m_width, m_heightPadding + 5);
-        SCE_CONSOLE_OUTPUT << "Next piece:";
+        if (m_isHeadless)
+        {
+            return;
+        }
 
-        for (int heightIndex = 0; heightIndex < t_height; heightIndex++)
+        this_displayFutureBox(std::string(t_futureGameObject, t_width * t_height), t_width, t_height);
+
+        return;
+    }
+
+    void ConsoleEngine::renderGameObject(const GameObjectCell* t_cells, int t_cellCount, char t_font, int t_currentXPosition, int t_currentYPosition)
+    {
+        if (m_isHeadless)
         {
-            for (int widthIndex = 0; widthIndex < t_width; widthIndex++)
+            return;
+        }
+
+        // Only the occupied cells are stored, so every one of them has font on it
+        for (int cellIndex = 0; cellIndex < t_cellCount; cellIndex++)
+        {
+            int boardX = t_currentXPosition + t_cells[cellIndex].x;
+            int boardY = t_currentYPosition + t_cells[cellIndex].y;
+
+            moveCursorTo(m_widthPadding + boardX, m_heightPadding + boardY);
+            this_print(t_font);
+
+            // The object covers the board, so remember it for the next screen update
+            if (boardX >= 0 && boardX < m_width && boardY >= 0 && boardY < m_height)
+            {
+                m_screenShadow[boardY * m_width + boardX] = t_font;
+            }
+        }
+
+        return;
+    }
+
+    // The whole box is printed, so a bigger previous piece gets erased
+    void ConsoleEngine::displayFutureGameObject(const GameObjectCell* t_cells, int t_cellCount, char t_font, int t_boxWidth, int t_boxHeight)
+    {
+        if (m_isHeadless)
+        {
+            return;
+        }
+
+        std::string box(t_boxWidth * t_boxHeight, m_emptyFont);
+        for (int cellIndex = 0; cellIndex < t_cellCount; cellIndex++)
+        {
+            if (t_cells[cellIndex].x < t_boxWidth && t_cells[cellIndex].y < t_boxHeight)
+            {
+                box[t_cells[cellIndex].y * t_boxWidth + t_cells[cellIndex].x] = t_font;
+            }
+        }
+
+        this_displayFutureBox(box, t_boxWidth, t_boxHeight);
+
+        return;
+    }
+
+    void ConsoleEngine::beginFrame()
+    {
+        m_frameBytes = 0;
+        m_frameCursorMoves = 0;
+
+        m_frameStartMs = this_nowMs();
+        m_lastFrameStartMs = m_frameStartMs;
+
+        // Whatever was pending is drawn by this frame
+        m_isFramePending = false;
+        m_isFrameRefused = false;
+
+        return;
+    }
+
+    void ConsoleEngine::endFrame()
+    {
+        m_lastFrameBytes = m_frameBytes;
+        m_lastFrameCursorMoves = m_frameCursorMoves;
+
+        m_frameCount++;
+        m_peakFrameBytes = (m_frameBytes > m_peakFrameBytes) ? m_frameBytes : m_peakFrameBytes;
+        m_peakFrameCursorMoves = (m_frameCursorMoves > m_peakFrameCursorMoves) ? m_frameCursorMoves : m_peakFrameCursorMoves;
+
+        // Push the frame out, so the time measured is the time the console took to take it
+        if (m_terminal == nullptr)
+        {
+            SCE_CONSOLE_OUTPUT.flush();
+        }
+
+        // A manual clock only moves while rendering when the virtual terminal plays a slow console,
+        // otherwise the console looks infinitely fast
+        double frameCostMs = this_nowMs() - m_frameStartMs;
+
+        // Smooth the measurements, a single slow write should not change the pacing
+        m_renderCostMs = 0.75 * m_renderCostMs + 0.25 * frameCostMs;
+        if (frameCostMs > 0.0 && m_frameBytes > 0)
+        {
+            double frameBytesPerMs = m_frameBytes / frameCostMs;
+            m_bytesPerMs = (m_bytesPerMs == 0.0) ? frameBytesPerMs : 0.75 * m_bytesPerMs + 0.25 * frameBytesPerMs;
+        }
+
+        // Print only the changes while a whole playground would not fit in the budget,
+        // and go back to whole frames once it comfortably does
+        if (m_bytesPerMs > 0.0)
+        {
+            double fullScreenCostMs = (m_width * m_height) / m_bytesPerMs;
+
+            if (fullScreenCostMs > SCE_FRAME_BUDGET_MS)
+            {
+                m_isMinimalUpdateMode = true;
+            }
+            else if (fullScreenCostMs < SCE_FRAME_BUDGET_MS / 2)
             {
-                moveCursorTo(2 * m_widthPadding + m_width + widthIndex + 3, m_heightPadding + 5 + 2 + heightIndex);
-                SCE_CONSOLE_OUTPUT << t_futureGameObject[heightIndex * t_width + widthIndex];
+                m_isMinimalUpdateMode = false;
             }
         }
 
+        // Keep the console busy for at most half of the time when frames are over budget
+        m_minFrameIntervalMs = (m_renderCostMs > SCE_FRAME_BUDGET_MS) ? 2 * m_renderCostMs : 0.0;
+
+        return;
+    }
+
+    // A frame is dropped only when a new one replaces a pending frame the pacing already refused
+    void ConsoleEngine::requestFrame()
+    {
+        if (m_isFramePending && m_isFrameRefused)
+        {
+            m_droppedFrames++;
+        }
+
+        m_isFramePending = true;
+        m_isFrameRefused = false;
+
         return;
     }
 
+    // Asking again for the same pending frame is not a new drop
+    bool ConsoleEngine::isTimeToRender()
+    {
+        if (!m_isFramePending)
+        {
+            return false;
+        }
+
+        double sinceLastFrameMs = this_nowMs() - m_lastFrameStartMs;
+
+        if (sinceLastFrameMs < m_minFrameIntervalMs)
+        {
+            m_isFrameRefused = true;
+            return false;
+        }
+
+        return true;
+    }
+
     //********************************************************************************
 
     bool ConsoleEngine::isBorder(int t_widthIndex, int t_heightIndex) const
@@ -178,10 +410,39 @@ namespace SCE { namespace graphics {
         return false;
     }
 
+    // Costs one check per occupied cell instead of one per cell of the bounding box
+    bool ConsoleEngine::isGoingToCollide(const GameObjectCell* t_cells, int t_cellCount, int t_currentXPosition, int t_currentYPosition) const
+    {
+        for (int cellIndex = 0; cellIndex < t_cellCount; cellIndex++)
+        {
+            int boardX = t_currentXPosition + t_cells[cellIndex].x;
+            int boardY = t_currentYPosition + t_cells[cellIndex].y;
+
+            // Outside the game instance counts as a collision
+            if (boardX < 0 || boardX >= m_width || boardY < 0 || boardY >= m_height)
+            {
+                return true;
+            }
+
+            if (m_gameInstance[boardY * m_width + boardX] != m_emptyFont)
+            {
+                return true; // Is going to collide
+            }
+        }
+
+        return false;
+    }
+
     //********************************************************************************
 
     void ConsoleEngine::setCursorVisibility(bool t_visibiltyFlag)
     {
+        // The virtual terminal has no cursor to hide
+        if (m_terminal != nullptr || m_isHeadless)
+        {
+            return;
+        }
+
         HANDLE handleOut = GetStdHandle(STD_OUTPUT_HANDLE);
         CONSOLE_CURSOR_INFO cursorInfo;
         cursorInfo.dwSize = 100;
@@ -193,8 +454,22 @@ namespace SCE { namespace graphics {
 
     void ConsoleEngine::moveCursorTo(int t_widthIndex, int t_heightIndex)
     {
+        if (m_isHeadless)
+        {
+            return;
+        }
+
+        m_frameCursorMoves++;
+
+        if (m_terminal != nullptr)
+        {
+            m_terminal->moveCursorTo(t_widthIndex, t_heightIndex);
+            this_spendTerminalTime(m_terminal->getMsPerCursorMove());
+            return;
+        }
+
         HANDLE handleOut = GetStdHandle(STD_OUTPUT_HANDLE);
-        COORD coord = { t_widthIndex, t_heightIndex };
+        COORD coord = { static_cast<SHORT>(t_widthIndex), static_cast<SHORT>(t_heightIndex) };
         SetConsoleCursorPosition(handleOut, coord);
 
         return;
@@ -202,15 +477,30 @@ namespace SCE { namespace graphics {
 
     void ConsoleEngine::clearConsoleScreen()
     {
-        system("cls");
+        if (m_terminal != nullptr)
+        {
+            m_terminal->clear();
+        }
+        else if (!m_isHeadless)
+        {
+            system("cls");
+        }
         moveCursorTo(0, 0);
 
+        // The playground is gone from the console
+        this_invalidateShadow();
+
         return;
     }
 
     // This returns instant response when called
     bool ConsoleEngine::isThisKeyPressed(int t_keyToCheck) const
     {
+        if (m_input != nullptr)
+        {
+            return m_input->isKeyPressed(t_keyToCheck);
+        }
+
         if (GetAsyncKeyState(t_keyToCheck) & 0x8000)
         {
             return true; // The key was pressed
@@ -219,6 +509,119 @@ namespace SCE { namespace graphics {
         return false;
     }
 
+    void ConsoleEngine::attachTerminal(VirtualTerminal* t_terminal)
+    {
+        m_terminal = t_terminal;
+
+        return;
+    }
+
+    // Nothing is printed and no effect is played, for games nobody watches
+    void ConsoleEngine::setHeadless(bool t_headlessFlag)
+    {
+        m_isHeadless = t_headlessFlag;
+
+        if (m_isHeadless)
+        {
+            m_effects.cancelAll();
+        }
+
+        return;
+    }
+
+    // The script is owned by the caller and moved forward by it
+    void ConsoleEngine::attachInput(const InputScript* t_input)
+    {
+        m_input = t_input;
+
+        return;
+    }
+
+    // Switching keeps the current time, so effects and pacing carry on
+    void ConsoleEngine::setManualClock(bool t_manualClockFlag)
+    {
+        if (t_manualClockFlag == m_isManualClock)
+        {
+            return;
+        }
+
+        // On whole milliseconds every time difference is exact, so replays never depend on rounding
+        if (t_manualClockFlag)
+        {
+            m_manualClockMs = std::floor(this_nowMs());
+        }
+        else
+        {
+            m_clockStart = std::chrono::steady_clock::now() -
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(m_manualClockMs));
+        }
+        m_isManualClock = t_manualClockFlag;
+
+        return;
+    }
+
+    // Sleeps on the real clock, only moves the time forward on a manual one
+    void ConsoleEngine::waitFor(int t_durationMs)
+    {
+        if (t_durationMs <= 0)
+        {
+            return;
+        }
+
+        if (m_isManualClock)
+        {
+            m_manualClockMs += t_durationMs;
+        }
+        else
+        {
+            Sleep(static_cast<DWORD>(t_durationMs));
+        }
+
+        return;
+    }
+
+    //********************************************************************************
+
+    // The text blinks in the middle of the playground
+    int ConsoleEngine::playBanner(const std::string& t_text, int t_durationMs)
+    {
+        if (m_isHeadless)
+        {
+            return 0;
+        }
+
+        return m_effects.schedule(EffectType::BANNER, m_height / 2, t_text, t_durationMs, this_nowMs());
+    }
+
+    // Call it every loop frame, returns true while effects play and then asks for a frame,
+    // an animation step is not a new game state so it never counts as a dropped frame
+    bool ConsoleEngine::updateEffects()
+    {
+        if (!m_effects.advance(this_nowMs()))
+        {
+            return false;
+        }
+
+        m_isFramePending = true;
+
+        return true;
+    }
+
+    // Takes the id returned when the effect was played
+    void ConsoleEngine::cancelEffect(int t_effectId)
+    {
+        m_effects.cancel(t_effectId);
+
+        return;
+    }
+
+    void ConsoleEngine::cancelEffects()
+    {
+        m_effects.cancelAll();
+
+        return;
+    }
+
     //********************************************************************************
 
     void ConsoleEngine::changeAtPosition(int t_widthIndex, int t_heightIndex, char t_newFont)
@@ -258,12 +661,14 @@ namespace SCE { namespace graphics {
 
     void ConsoleEngine::updateGameBoard(int t_lineNumber)
     {
-        // Empty the line with a little animation
-        for (int widthIndex = 1; widthIndex < m_lastColumn; widthIndex++)
+        constexpr int CLEAR_DELAY_PER_BLOCK = 50;
+
+        // Empty the line with a little animation, played while the game goes on
+        if (!m_isHeadless)
         {
-            moveCursorTo(m_widthPadding + widthIndex, m_heightPadding + t_lineNumber);
-            SCE_CONSOLE_OUTPUT << m_emptyFont;
-            Sleep(50);
+            std::string clearedBlocks(m_gameInstance + t_lineNumber * m_width + 1, m_lastColumn - 1);
+            m_effects.schedule(EffectType::LINE_CLEAR, t_lineNumber, clearedBlocks,
+                CLEAR_DELAY_PER_BLOCK * (m_lastColumn - 1), this_nowMs());
         }
 
         // Move the upper pieces down a level for the highest line
@@ -285,8 +690,7 @@ namespace SCE { namespace graphics {
 
         // Update score
         m_score += 100;
-
-        renderGameScreen();
+        m_lines++;
 
         return;
     }
@@ -295,18 +699,197 @@ namespace SCE { namespace graphics {
     //                                Private methods
     //********************************************************************************
 
+    // Whole frames print the texts every time, minimal updates only when they changed
     void ConsoleEngine::this_displayScore()
     {
-        moveCursorTo(2 * m_widthPadding + m_width, m_heightPadding);
-        SCE_CONSOLE_OUTPUT << "SCORE: " << getMyScore();
+        if (!m_isMinimalUpdateMode || m_shownScore != m_score)
+        {
+            moveCursorTo(2 * m_widthPadding + m_width, m_heightPadding);
+            this_print("SCORE: " + std::to_string(getMyScore()));
+            m_shownScore = m_score;
+        }
+
+        // Only shown once the console was too slow for the game
+        if (m_droppedFrames > 0 && (!m_isMinimalUpdateMode || m_shownDroppedFrames != m_droppedFrames))
+        {
+            moveCursorTo(2 * m_widthPadding + m_width, m_heightPadding + 2);
+            this_print("DROPPED FRAMES: " + std::to_string(m_droppedFrames));
+            m_shownDroppedFrames = m_droppedFrames;
+        }
 
         return;
     }
 
     void ConsoleEngine::this_displayLogo()
     {
+        if (m_isMinimalUpdateMode && m_isLogoShown)
+        {
+            return;
+        }
+
         moveCursorTo(2 * m_widthPadding + m_width, m_heightPadding + m_lastLine);
-        SCE_CONSOLE_OUTPUT << "Made by Stipl3x";
+        this_print("Made by Stipl3x");
+        m_isLogoShown = true;
+
+        return;
+    }
+
+    void ConsoleEngine::this_displayFutureBox(const std::string& t_box, int t_boxWidth, int t_boxHeight)
+    {
+        if (m_isMinimalUpdateMode && m_shownFutureBox == t_box)
+        {
+            return;
+        }
+
+        moveCursorTo(2 * m_widthPadding + m_width, m_heightPadding + 5);
+        this_print("Next piece:");
+
+        for (int heightIndex = 0; heightIndex < t_boxHeight; heightIndex++)
+        {
+            moveCursorTo(2 * m_widthPadding + m_width + 3, m_heightPadding + 5 + 2 + heightIndex);
+            this_print(t_box.c_str() + heightIndex * t_boxWidth, t_boxWidth);
+        }
+        m_shownFutureBox = t_box;
+
+        return;
+    }
+
+    // Every character goes through here, so the frame output can be measured
+    void ConsoleEngine::this_print(char t_font)
+    {
+        if (m_isHeadless)
+        {
+            return;
+        }
+
+        m_frameBytes++;
+
+        if (m_terminal != nullptr)
+        {
+            m_terminal->write(t_font);
+            this_spendTerminalTime(m_terminal->getMsPerByte());
+        }
+        else
+        {
+            SCE_CONSOLE_OUTPUT << t_font;
+        }
+
+        return;
+    }
+
+    void ConsoleEngine::this_print(const char* t_text, int t_length)
+    {
+        if (m_isHeadless)
+        {
+            return;
+        }
+
+        m_frameBytes += t_length;
+
+        if (m_terminal != nullptr)
+        {
+            for (int index = 0; index < t_length; index++)
+            {
+                m_terminal->write(t_text[index]);
+            }
+            this_spendTerminalTime(t_length * m_terminal->getMsPerByte());
+        }
+        else
+        {
+            SCE_CONSOLE_OUTPUT.write(t_text, t_length);
+        }
+
+        return;
+    }
+
+    void ConsoleEngine::this_print(const std::string& t_text)
+    {
+        this_print(t_text.c_str(), static_cast<int>(t_text.size()));
+
+        return;
+    }
+
+    // One cursor move per line, since printing advances the cursor
+    void ConsoleEngine::this_printLine(const char* t_frame, int t_heightIndex)
+    {
+        // Add paddings to the indexes to move the game position on console
+        moveCursorTo(m_widthPadding, t_heightIndex + m_heightPadding);
+        this_print(t_frame + t_heightIndex * m_width, m_width);
+
+        for (int widthIndex = 0; widthIndex < m_width; widthIndex++)
+        {
+            m_screenShadow[t_heightIndex * m_width + widthIndex] = t_frame[t_heightIndex * m_width + widthIndex];
+        }
+
+        return;
+    }
+
+    // Print only the runs of the line that differ from what the console shows
+    void ConsoleEngine::this_printChangesOnLine(const char* t_frame, int t_heightIndex)
+    {
+        int lineStart = t_heightIndex * m_width;
+        int widthIndex = 0;
+
+        while (widthIndex < m_width)
+        {
+            if (m_screenShadow[lineStart + widthIndex] == t_frame[lineStart + widthIndex])
+            {
+                widthIndex++;
+                continue;
+            }
+
+            int runStart = widthIndex;
+            while (widthIndex < m_width && m_screenShadow[lineStart + widthIndex] != t_frame[lineStart + widthIndex])
+            {
+                m_screenShadow[lineStart + widthIndex] = t_frame[lineStart + widthIndex];
+                widthIndex++;
+            }
+
+            moveCursorTo(m_widthPadding + runStart, t_heightIndex + m_heightPadding);
+            this_print(t_frame + lineStart + runStart, widthIndex - runStart);
+        }
+
+        return;
+    }
+
+    void ConsoleEngine::this_invalidateShadow()
+    {
+        m_shownScore = -1;
+        m_shownDroppedFrames = -1;
+        m_isLogoShown = false;
+        m_shownFutureBox.clear();
+
+        if (m_screenShadow == nullptr)
+        {
+            return;
+        }
+
+        for (int index = 0; index < m_width * m_height; index++)
+        {
+            m_screenShadow[index] = '\0';
+        }
+
+        return;
+    }
+
+    double ConsoleEngine::this_nowMs() const
+    {
+        if (m_isManualClock)
+        {
+            return m_manualClockMs;
+        }
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_clockStart).count();
+    }
+
+    // A slow virtual terminal takes its time on the manual clock, on the real clock
+    // the write itself already took it
+    void ConsoleEngine::this_spendTerminalTime(double t_durationMs)
+    {
+        if (m_isManualClock)
+        {
+            m_manualClockMs += t_durationMs;
+        }
 
         return;
     }
@@ -21,11 +21,30 @@
 #define SCE_CONSOLE_INPUT std::cin
 #define SCE_CONSOLE_NEW_LINE std::endl
 
+// Version of the engine, as major * 10000 + minor * 100 + patch
+#define SCE_ENGINE_VERSION 10000
+
+// Time a frame may spend writing to the console before the pacing kicks in
+#define SCE_FRAME_BUDGET_MS 20.0
+
+#include <chrono>
 #include <iostream>
+#include <string>
 #include <Windows.h>
 
+#include "effects.hpp"
+#include "input.hpp"
+#include "terminal.hpp"
+
 namespace SCE { namespace graphics {
 
+    // One occupied block of a game object, relative to the top-left of its bounding box
+    struct GameObjectCell
+    {
+        int x;
+        int y;
+    };
+
     class ConsoleEngine
     {
     public:
@@ -38,6 +57,17 @@ namespace SCE { namespace graphics {
         //*****Public Methods*****
         // Getters
         int getMyScore() const;
+        int getMyLines() const;
+        int getLastFrameBytes() const;
+        int getLastFrameCursorMoves() const;
+        int getDroppedFrames() const;
+        int getFrameCount() const;
+        int getPeakFrameBytes() const;
+        int getPeakFrameCursorMoves() const;
+        bool isMinimalUpdateMode() const;
+        bool isHeadless() const;
+        bool hasEffects() const;
+        double getTimeMs() const;
 
         // Essential game functions
         void reset();
@@ -46,9 +76,22 @@ namespace SCE { namespace graphics {
         void renderGameObject(char* t_currentGameObject, int t_width, int t_height, int t_currentXPosition, int t_currentYPosition);
         void displayFutureGameObject(char* t_futureGameObject, int t_width, int t_height);
 
+        // Same as above, for game objects stored as a list of occupied cells
+        void renderGameObject(const GameObjectCell* t_cells, int t_cellCount, char t_font, int t_currentXPosition, int t_currentYPosition);
+        void displayFutureGameObject(const GameObjectCell* t_cells, int t_cellCount, char t_font, int t_boxWidth, int t_boxHeight);
+
+        // Frame bounds, used to measure the output emitted by one frame
+        void beginFrame();
+        void endFrame();
+
+        // Frame pacing, a requested frame is rendered once the pacing allows it
+        void requestFrame();
+        bool isTimeToRender();
+
         // Game checkers
         bool isBorder(int t_widthIndex, int t_heightIndex) const;
         bool isGoingToCollide(char* t_currentGameObject, int t_width, int t_height, int t_currentXPosition, int t_currentYPosition) const;
+        bool isGoingToCollide(const GameObjectCell* t_cells, int t_cellCount, int t_currentXPosition, int t_currentYPosition) const;
 
         // Console components - Windows
         void setCursorVisibility(bool t_visibiltyFlag);
@@ -56,6 +99,23 @@ namespace SCE { namespace graphics {
         void clearConsoleScreen();
         bool isThisKeyPressed(int t_keyToCheck) const;
 
+        // Output redirection - nullptr goes back to the real console
+        void attachTerminal(VirtualTerminal* t_terminal);
+        void setHeadless(bool t_headlessFlag);
+
+        // Input redirection - nullptr goes back to the real keyboard
+        void attachInput(const InputScript* t_input);
+
+        // Engine clock, a manual clock only moves forward by waiting on it or by writing to a slow virtual terminal
+        void setManualClock(bool t_manualClockFlag);
+        void waitFor(int t_durationMs);
+
+        // Timed effects, played over the game instance by renderGameScreen
+        int playBanner(const std::string& t_text, int t_durationMs);
+        bool updateEffects();
+        void cancelEffect(int t_effectId);
+        void cancelEffects();
+
         // Game instance modifiers
         void changeAtPosition(int t_widthIndex, int t_heightIndex, char t_newFont);
         void checkForLines();
@@ -83,12 +143,68 @@ namespace SCE { namespace graphics {
         // Game instance
         char* m_gameInstance;
 
+        // What the console shows for the game instance, '\0' means unknown
+        char* m_screenShadow;
+
+        // Game instance with the effects drawn over it
+        char* m_frameBuffer;
+
+        // What the console shows next to the game instance, -1 and empty mean unknown
+        int m_shownScore;
+        int m_shownDroppedFrames;
+        bool m_isLogoShown;
+        std::string m_shownFutureBox;
+
         // Game components
         int m_score;
+        int m_lines;
+
+        // Output components
+        VirtualTerminal* m_terminal;
+        bool m_isHeadless;
+
+        int m_frameBytes;
+        int m_frameCursorMoves;
+        int m_lastFrameBytes;
+        int m_lastFrameCursorMoves;
+        int m_frameCount;
+        int m_peakFrameBytes;
+        int m_peakFrameCursorMoves;
+
+        // Input components
+        const InputScript* m_input;
+
+        // Frame pacing components
+        double m_frameStartMs;
+        double m_lastFrameStartMs;
+        double m_renderCostMs;
+        double m_bytesPerMs;
+        double m_minFrameIntervalMs;
+        int m_droppedFrames;
+        bool m_isMinimalUpdateMode;
+        bool m_isFramePending;
+        bool m_isFrameRefused;
+
+        // Clock components, the pacing and the effects both run on this clock
+        std::chrono::steady_clock::time_point m_clockStart;
+        bool m_isManualClock;
+        double m_manualClockMs;
+
+        // Effect components
+        EffectScheduler m_effects;
 
         //*****Private Methods*****
+        void this_print(char t_font);
+        void this_print(const char* t_text, int t_length);
+        void this_print(const std::string& t_text);
+        void this_printLine(const char* t_frame, int t_heightIndex);
+        void this_printChangesOnLine(const char* t_frame, int t_heightIndex);
+        void this_invalidateShadow();
+        double this_nowMs() const;
+        void this_spendTerminalTime(double t_durationMs);
         void this_displayScore();
         void this_displayLogo();
+        void this_displayFutureBox(const std::string& t_box, int t_boxWidth, int t_boxHeight);
     };
 
 } }
@@ -0,0 +1,94 @@
+// (C) Stipl3x 2020
+
+#include "input.hpp"
+
+#include <Windows.h>
+
+namespace SCE { namespace graphics {
+
+    InputScript::InputScript() : m_tick(0) { }
+    InputScript::~InputScript() { }
+
+    //********************************************************************************
+
+    int InputScript::getTick() const { return m_tick; }
+
+    bool InputScript::isKeyPressed(int t_keyToCheck) const
+    {
+        for (const ScriptedPress& scriptedPress : m_presses)
+        {
+            if (scriptedPress.key == t_keyToCheck && m_tick >= scriptedPress.firstTick && m_tick <= scriptedPress.lastTick)
+            {
+                return true; // The key is held on this tick
+            }
+        }
+
+        return false;
+    }
+
+    //********************************************************************************
+
+    bool InputScript::press(int t_firstTick, int t_lastTick, const std::string& t_keyName)
+    {
+        int key = 0;
+
+        // Letters and digits use their own character as virtual key code
+        if (t_keyName.size() == 1 && ((t_keyName[0] >= 'A' && t_keyName[0] <= 'Z') || (t_keyName[0] >= '0' && t_keyName[0] <= '9')))
+        {
+            key = t_keyName[0];
+        }
+        else if (t_keyName == "SPACE")
+        {
+            key = VK_SPACE;
+        }
+        else if (t_keyName == "RETURN")
+        {
+            key = VK_RETURN;
+        }
+        else if (t_keyName == "ESCAPE")
+        {
+            key = VK_ESCAPE;
+        }
+        else if (t_keyName == "LEFT")
+        {
+            key = VK_LEFT;
+        }
+        else if (t_keyName == "RIGHT")
+        {
+            key = VK_RIGHT;
+        }
+        else if (t_keyName == "UP")
+        {
+            key = VK_UP;
+        }
+        else if (t_keyName == "DOWN")
+        {
+            key = VK_DOWN;
+        }
+        else
+        {
+            return false;
+        }
+
+        ScriptedPress scriptedPress = { t_firstTick, t_lastTick, key };
+        m_presses.push_back(scriptedPress);
+
+        return true;
+    }
+
+    void InputScript::setTick(int t_tick)
+    {
+        m_tick = t_tick;
+
+        return;
+    }
+
+    void InputScript::clear()
+    {
+        m_presses.clear();
+        m_tick = 0;
+
+        return;
+    }
+
+} }
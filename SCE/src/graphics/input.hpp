@@ -0,0 +1,57 @@
+#pragma once
+
+// (C) Stipl3x 2020
+
+/*
+ * The InputScript class is an in-memory replacement for the keyboard.
+ * Once attached to a ConsoleEngine, isThisKeyPressed answers from the
+ * script instead of the real keyboard. A script is a list of keys held
+ * down from a first tick to a last tick, both included, and the owner
+ * moves the script forward one tick at a time, so a game loop frame
+ * always sees the same keys whatever the speed of the machine.
+ * Keys are named by their character ('A', 'D', ...) or by the names
+ * SPACE, RETURN, ESCAPE, LEFT, RIGHT, UP and DOWN.
+ *
+ * GNU GPLv3
+ * (C) Stipl3x 2020
+ *
+ */
+
+#include <string>
+#include <vector>
+
+namespace SCE { namespace graphics {
+
+    struct ScriptedPress
+    {
+        int firstTick;
+        int lastTick;
+        int key;
+    };
+
+    class InputScript
+    {
+    public:
+        InputScript(); // Constructor
+        ~InputScript(); // Destructor
+
+        //*****Public Methods*****
+        // Getters
+        int getTick() const;
+        bool isKeyPressed(int t_keyToCheck) const;
+
+        // Script components, press returns false for an unknown key name
+        bool press(int t_firstTick, int t_lastTick, const std::string& t_keyName);
+        void setTick(int t_tick);
+        void clear();
+
+
+
+        //*****Only hidden class stuff*****
+    private:
+        //*****Private Variables*****
+        std::vector<ScriptedPress> m_presses;
+        int m_tick;
+    };
+
+} }
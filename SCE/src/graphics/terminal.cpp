@@ -0,0 +1,136 @@
+// (C) Stipl3x 2020
+
+#include "terminal.hpp"
+
+#include <fstream>
+#include <sstream>
+
+namespace SCE { namespace graphics {
+
+    VirtualTerminal::VirtualTerminal(int t_width, int t_height)
+        : m_width(t_width), m_height(t_height), m_cursorX(0), m_cursorY(0), m_screen(nullptr),
+          m_msPerByte(0.0), m_msPerCursorMove(0.0)
+    {
+        m_screen = new char[m_width * m_height];
+        clear();
+    }
+
+    VirtualTerminal::~VirtualTerminal() { delete[] m_screen; }
+
+    //********************************************************************************
+
+    int VirtualTerminal::getWidth() const { return m_width; }
+    int VirtualTerminal::getHeight() const { return m_height; }
+    double VirtualTerminal::getMsPerByte() const { return m_msPerByte; }
+    double VirtualTerminal::getMsPerCursorMove() const { return m_msPerCursorMove; }
+
+    char VirtualTerminal::getCharAt(int t_widthIndex, int t_heightIndex) const
+    {
+        if (t_widthIndex < 0 || t_widthIndex >= m_width || t_heightIndex < 0 || t_heightIndex >= m_height)
+        {
+            return ' ';
+        }
+
+        return m_screen[t_heightIndex * m_width + t_widthIndex];
+    }
+
+    // Every line of the screen followed by a new line, trailing spaces included
+    std::string VirtualTerminal::getScreen() const
+    {
+        std::string screen;
+        screen.reserve((m_width + 1) * m_height);
+
+        for (int heightIndex = 0; heightIndex < m_height; heightIndex++)
+        {
+            screen.append(m_screen + heightIndex * m_width, m_width);
+            screen.push_back('\n');
+        }
+
+        return screen;
+    }
+
+    //********************************************************************************
+
+    void VirtualTerminal::moveCursorTo(int t_widthIndex, int t_heightIndex)
+    {
+        m_cursorX = t_widthIndex;
+        m_cursorY = t_heightIndex;
+
+        return;
+    }
+
+    void VirtualTerminal::write(char t_font)
+    {
+        if (t_font == '\n')
+        {
+            m_cursorX = 0;
+            m_cursorY++;
+            return;
+        }
+
+        // Behave like the console and wrap on the next line
+        if (m_cursorX >= m_width)
+        {
+            m_cursorX = 0;
+            m_cursorY++;
+        }
+
+        if (m_cursorX >= 0 && m_cursorY >= 0 && m_cursorY < m_height)
+        {
+            m_screen[m_cursorY * m_width + m_cursorX] = t_font;
+        }
+        m_cursorX++;
+
+        return;
+    }
+
+    // The terminal only keeps the costs, the engine spends them on its clock
+    void VirtualTerminal::setWriteCosts(double t_msPerByte, double t_msPerCursorMove)
+    {
+        m_msPerByte = t_msPerByte;
+        m_msPerCursorMove = t_msPerCursorMove;
+
+        return;
+    }
+
+    void VirtualTerminal::clear()
+    {
+        for (int index = 0; index < m_width * m_height; index++)
+        {
+            m_screen[index] = ' ';
+        }
+        moveCursorTo(0, 0);
+
+        return;
+    }
+
+    //********************************************************************************
+
+    bool VirtualTerminal::saveScreen(const std::string& t_filePath) const
+    {
+        std::ofstream goldenFile(t_filePath);
+        if (!goldenFile)
+        {
+            return false;
+        }
+
+        goldenFile << getScreen();
+
+        return static_cast<bool>(goldenFile);
+    }
+
+    bool VirtualTerminal::matchesScreen(const std::string& t_filePath) const
+    {
+        std::ifstream goldenFile(t_filePath);
+        if (!goldenFile)
+        {
+            return false;
+        }
+
+        std::stringstream goldenScreen;
+        goldenScreen << goldenFile.rdbuf();
+
+        return goldenScreen.str() == getScreen();
+    }
+
+} }
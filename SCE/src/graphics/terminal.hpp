@@ -0,0 +1,77 @@
+#pragma once
+
+// (C) Stipl3x 2020
+
+/*
+ * The VirtualTerminal class is an in-memory replacement for the console.
+ * Once attached to a ConsoleEngine, every cursor move and every character
+ * the engine emits lands in a Width x Height grid of characters instead of
+ * the real console, using the same top-left XY coordinates system.
+ * Characters written past the last column wrap on the next line, like the
+ * console does, and anything outside the grid is dropped.
+ * The captured screen can be saved as a golden file and compared later,
+ * so rendering changes can be checked for visual regressions.
+ * A terminal can also play a slow console: every character and every
+ * cursor move then costs some time, which an engine on a manual clock
+ * adds to its clock, so the frame pacing can be replayed as well.
+ *
+ * GNU GPLv3
+ * (C) Stipl3x 2020
+ *
+ */
+
+#include <string>
+
+namespace SCE { namespace graphics {
+
+    class VirtualTerminal
+    {
+    public:
+        VirtualTerminal(int t_width, int t_height); // Constructor
+        ~VirtualTerminal(); // Destructor
+
+        // The screen memory is owned, so the terminal can not be copied
+        VirtualTerminal(const VirtualTerminal&) = delete;
+        VirtualTerminal& operator=(const VirtualTerminal&) = delete;
+
+        //*****Public Methods*****
+        // Getters
+        int getWidth() const;
+        int getHeight() const;
+        char getCharAt(int t_widthIndex, int t_heightIndex) const;
+        std::string getScreen() const;
+        double getMsPerByte() const;
+        double getMsPerCursorMove() const;
+
+        // Simulated console speed, 0 for an infinitely fast console
+        void setWriteCosts(double t_msPerByte, double t_msPerCursorMove);
+
+        // Console components - Virtual
+        void moveCursorTo(int t_widthIndex, int t_heightIndex);
+        void write(char t_font);
+        void clear();
+
+        // Golden frames
+        bool saveScreen(const std::string& t_filePath) const;
+        bool matchesScreen(const std::string& t_filePath) const;
+
+
+
+        //*****Only hidden class stuff*****
+    private:
+        //*****Private Variables*****
+        int m_width;
+        int m_height;
+
+        int m_cursorX;
+        int m_cursorY;
+
+        // Screen memory, indexed as Y_position * Width + X_position
+        char* m_screen;
+
+        // Simulated console speed
+        double m_msPerByte;
+        double m_msPerCursorMove;
+    };
+
+} }
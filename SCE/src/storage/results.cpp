@@ -0,0 +1,578 @@
+// (C) Stipl3x 2020
+
+#include "results.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+
+namespace SCE { namespace storage {
+
+    constexpr std::uint64_t RESULTS_MAGIC = 0x3130534552454353ull; // "SCERES01"
+    constexpr std::uint64_t INDEX_MAGIC = 0x3130584449454353ull; // "SCEIDX01"
+    constexpr std::uint64_t INITIAL_CAPACITY = 4096;
+
+    static bool IsBefore(const IndexEntry& t_first, const IndexEntry& t_second)
+    {
+        if (t_first.key != t_second.key)
+        {
+            return t_first.key < t_second.key;
+        }
+
+        return t_first.recordNumber < t_second.recordNumber;
+    }
+
+    //********************************************************************************
+    //                                  MappedFile
+    //********************************************************************************
+
+    MappedFile::MappedFile()
+        : m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr), m_data(nullptr), m_mappedSize(0) { }
+    MappedFile::~MappedFile() { close(); }
+
+    //********************************************************************************
+
+    char* MappedFile::getData() const { return m_data; }
+    std::uint64_t MappedFile::getMappedSize() const { return m_mappedSize; }
+
+    std::uint64_t MappedFile::getFileSize() const
+    {
+        LARGE_INTEGER fileSize;
+        if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &fileSize))
+        {
+            return 0;
+        }
+
+        return static_cast<std::uint64_t>(fileSize.QuadPart);
+    }
+
+    //********************************************************************************
+
+    // With FILE_SHARE_DELETE an open file can be deleted by another process, it goes away once closed
+    bool MappedFile::open(const std::string& t_filePath, DWORD t_creationDisposition)
+    {
+        close();
+
+        m_file = CreateFileA(t_filePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, t_creationDisposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        return m_file != INVALID_HANDLE_VALUE;
+    }
+
+    void MappedFile::close()
+    {
+        this_unmap();
+
+        if (m_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_file);
+        }
+        m_file = INVALID_HANDLE_VALUE;
+
+        return;
+    }
+
+    // Maps at least t_size bytes, a mapping bigger than the file extends it
+    bool MappedFile::map(std::uint64_t t_size)
+    {
+        if (m_data != nullptr && t_size <= m_mappedSize)
+        {
+            return true;
+        }
+
+        this_unmap();
+
+        // Never map less than the file, other processes may have grown it
+        std::uint64_t fileSize = getFileSize();
+        std::uint64_t mappedSize = (t_size > fileSize) ? t_size : fileSize;
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE,
+            static_cast<DWORD>(mappedSize >> 32), static_cast<DWORD>(mappedSize & 0xFFFFFFFF), nullptr);
+        if (m_mapping == nullptr)
+        {
+            return false;
+        }
+
+        m_data = static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(mappedSize)));
+        if (m_data == nullptr)
+        {
+            this_unmap();
+            return false;
+        }
+        m_mappedSize = mappedSize;
+
+        return true;
+    }
+
+    //********************************************************************************
+
+    void MappedFile::this_unmap()
+    {
+        if (m_data != nullptr)
+        {
+            UnmapViewOfFile(m_data);
+        }
+        m_data = nullptr;
+        m_mappedSize = 0;
+
+        if (m_mapping != nullptr)
+        {
+            CloseHandle(m_mapping);
+        }
+        m_mapping = nullptr;
+
+        return;
+    }
+
+    //********************************************************************************
+    //                                 ResultsStore
+    //********************************************************************************
+
+    ResultsStore::ResultsStore() : m_indexGeneration(0), m_lock(nullptr), m_indexLock(nullptr) { }
+    ResultsStore::~ResultsStore() { close(); }
+
+    //********************************************************************************
+
+    bool ResultsStore::isOpen() const { return m_log.getData() != nullptr; }
+
+    std::uint64_t ResultsStore::getRecordCount() const
+    {
+        if (!isOpen())
+        {
+            return 0;
+        }
+
+        return static_cast<std::uint64_t>(this_logHeader()->recordCount);
+    }
+
+    bool ResultsStore::getRecord(std::uint64_t t_recordNumber, GameResult& t_result)
+    {
+        if (t_recordNumber >= getRecordCount() || !this_mapRecords(t_recordNumber + 1))
+        {
+            return false;
+        }
+
+        const GameResult* records = reinterpret_cast<const GameResult*>(m_log.getData() + sizeof(ResultsHeader));
+        t_result = records[t_recordNumber];
+
+        return true;
+    }
+
+    //********************************************************************************
+
+    bool ResultsStore::open(const std::string& t_filePath)
+    {
+        close();
+
+        // Every process opening the same log has to find the same mutexes
+        char fullPath[MAX_PATH];
+        if (GetFullPathNameA(t_filePath.c_str(), MAX_PATH, fullPath, nullptr) == 0)
+        {
+            return false;
+        }
+        std::string lockName = fullPath;
+        std::transform(lockName.begin(), lockName.end(), lockName.begin(),
+            [](unsigned char t_font) { return static_cast<char>(std::tolower(t_font)); });
+        lockName = "Local\\SCE_results_" + std::to_string(std::hash<std::string>()(lockName));
+
+        m_lock = CreateMutexA(nullptr, FALSE, lockName.c_str());
+        m_indexLock = CreateMutexA(nullptr, FALSE, (lockName + "_index").c_str());
+        if (m_lock == nullptr || m_indexLock == nullptr || !m_log.open(t_filePath))
+        {
+            close();
+            return false;
+        }
+        m_filePath = t_filePath;
+
+        // An abandoned append left at most a record that was never counted, the log is fine
+        bool b_isValid = true;
+        this_lock(m_lock);
+
+        // A new log starts with room for some records
+        if (m_log.getFileSize() < sizeof(ResultsHeader))
+        {
+            b_isValid = m_log.map(sizeof(ResultsHeader) + INITIAL_CAPACITY * sizeof(GameResult));
+            if (b_isValid)
+            {
+                ResultsHeader* header = this_logHeader();
+                header->magic = RESULTS_MAGIC;
+                header->recordSize = sizeof(GameResult);
+                header->capacity = INITIAL_CAPACITY;
+                header->oldestGeneration = 0;
+                InterlockedExchange64(&header->indexGeneration, 0);
+                InterlockedExchange64(&header->recordCount, 0);
+            }
+        }
+        else
+        {
+            b_isValid = m_log.map(m_log.getFileSize());
+            b_isValid = b_isValid && this_logHeader()->magic == RESULTS_MAGIC && this_logHeader()->recordSize == sizeof(GameResult);
+        }
+
+        this_unlock(m_lock);
+
+        if (!b_isValid)
+        {
+            close();
+        }
+
+        return b_isValid;
+    }
+
+    void ResultsStore::close()
+    {
+        m_log.close();
+        m_scoreIndex.close();
+        m_seedIndex.close();
+        m_indexGeneration = 0;
+        m_filePath.clear();
+
+        if (m_lock != nullptr)
+        {
+            CloseHandle(m_lock);
+        }
+        m_lock = nullptr;
+
+        if (m_indexLock != nullptr)
+        {
+            CloseHandle(m_indexLock);
+        }
+        m_indexLock = nullptr;
+
+        return;
+    }
+
+    bool ResultsStore::append(const GameResult& t_result)
+    {
+        if (!isOpen())
+        {
+            return false;
+        }
+
+        this_lock(m_lock);
+
+        // Another process may have grown the log since it was mapped here
+        std::uint64_t recordCount = static_cast<std::uint64_t>(this_logHeader()->recordCount);
+        std::uint64_t capacity = this_logHeader()->capacity;
+        bool b_isValid = this_mapRecords(capacity);
+
+        // Double the room when the log is full
+        if (b_isValid && recordCount == capacity)
+        {
+            capacity *= 2;
+            b_isValid = this_mapRecords(capacity);
+            if (b_isValid)
+            {
+                this_logHeader()->capacity = capacity;
+            }
+        }
+
+        if (b_isValid)
+        {
+            GameResult* records = reinterpret_cast<GameResult*>(m_log.getData() + sizeof(ResultsHeader));
+            records[recordCount] = t_result;
+
+            // The record has to be complete before it is counted
+            MemoryBarrier();
+            InterlockedExchange64(&this_logHeader()->recordCount, static_cast<LONG64>(recordCount + 1));
+        }
+
+        this_unlock(m_lock);
+
+        return b_isValid;
+    }
+
+    //********************************************************************************
+
+    // Builds the next generation next to the published one, appending is never blocked
+    bool ResultsStore::updateIndex()
+    {
+        if (!isOpen())
+        {
+            return false;
+        }
+
+        // When a builder died holding the lock, trust nothing but the log and start again
+        bool b_isAbandoned = this_lock(m_indexLock);
+
+        bool b_isValid = this_refreshIndex();
+        std::uint64_t recordCount = getRecordCount();
+        std::uint64_t indexedCount = (b_isAbandoned || m_indexGeneration == 0) ? 0 : this_entryCount(m_scoreIndex);
+
+        if (b_isValid && (b_isAbandoned || indexedCount != recordCount))
+        {
+            // Files of the same generation left by a dead builder are overwritten
+            std::uint64_t newGeneration = m_indexGeneration + 1;
+
+            MappedFile scoreIndex;
+            MappedFile seedIndex;
+            b_isValid = this_buildIndex(scoreIndex, m_scoreIndex, indexedCount, recordCount, true, newGeneration)
+                && this_buildIndex(seedIndex, m_seedIndex, indexedCount, recordCount, false, newGeneration);
+            scoreIndex.close();
+            seedIndex.close();
+
+            if (b_isValid)
+            {
+                InterlockedExchange64(&this_logHeader()->indexGeneration, static_cast<LONG64>(newGeneration));
+                b_isValid = this_refreshIndex();
+            }
+        }
+
+        // Also retries the generations a builder could not delete before
+        if (b_isValid)
+        {
+            this_deleteOldIndexes();
+        }
+
+        this_unlock(m_indexLock);
+
+        return b_isValid;
+    }
+
+    // Best scores first, equal scores in appending order
+    std::vector<GameResult> ResultsStore::getTopScores(int t_count)
+    {
+        std::vector<GameResult> topScores;
+        if (!isOpen() || t_count <= 0 || !this_refreshIndex() || m_indexGeneration == 0)
+        {
+            return topScores;
+        }
+
+        std::uint64_t entryCount = this_entryCount(m_scoreIndex);
+        const IndexEntry* entries = reinterpret_cast<const IndexEntry*>(m_scoreIndex.getData() + sizeof(IndexHeader));
+
+        // Ties are sorted by record number, so walk a run of equal scores forward
+        std::uint64_t position = entryCount;
+        while (position > 0 && topScores.size() < static_cast<std::size_t>(t_count))
+        {
+            std::uint64_t runEnd = position;
+            while (position > 0 && entries[position - 1].key == entries[runEnd - 1].key)
+            {
+                position--;
+            }
+
+            for (std::uint64_t runIndex = position; runIndex < runEnd && topScores.size() < static_cast<std::size_t>(t_count); runIndex++)
+            {
+                GameResult result;
+                if (this_readIndexed(m_scoreIndex, runIndex, result))
+                {
+                    topScores.push_back(result);
+                }
+            }
+        }
+
+        return topScores;
+    }
+
+    // Nearest rank, the 50th percentile of 1, 2, 3, 4 is 2
+    bool ResultsStore::getScoreAtPercentile(double t_percentile, int& t_score)
+    {
+        if (!isOpen() || t_percentile < 0.0 || t_percentile > 100.0 || !this_refreshIndex() || m_indexGeneration == 0)
+        {
+            return false;
+        }
+
+        std::uint64_t entryCount = this_entryCount(m_scoreIndex);
+        const IndexEntry* entries = reinterpret_cast<const IndexEntry*>(m_scoreIndex.getData() + sizeof(IndexHeader));
+        if (entryCount == 0)
+        {
+            return false;
+        }
+
+        std::uint64_t rank = static_cast<std::uint64_t>(t_percentile / 100.0 * entryCount);
+        if (static_cast<double>(rank) < t_percentile / 100.0 * entryCount)
+        {
+            rank++;
+        }
+        rank = (rank < 1) ? 1 : rank;
+
+        t_score = static_cast<int>(entries[rank - 1].key);
+
+        return true;
+    }
+
+    std::vector<GameResult> ResultsStore::getResultsForSeed(std::uint64_t t_seed)
+    {
+        std::vector<GameResult> seedResults;
+        if (!isOpen() || !this_refreshIndex() || m_indexGeneration == 0)
+        {
+            return seedResults;
+        }
+
+        std::uint64_t entryCount = this_entryCount(m_seedIndex);
+        const IndexEntry* entries = reinterpret_cast<const IndexEntry*>(m_seedIndex.getData() + sizeof(IndexHeader));
+        std::int64_t key = static_cast<std::int64_t>(t_seed);
+
+        const IndexEntry* entry = std::lower_bound(entries, entries + entryCount, key,
+            [](const IndexEntry& t_entry, std::int64_t t_key) { return t_entry.key < t_key; });
+
+        for (; entry != entries + entryCount && entry->key == key; entry++)
+        {
+            GameResult result;
+            if (this_readIndexed(m_seedIndex, static_cast<std::uint64_t>(entry - entries), result))
+            {
+                seedResults.push_back(result);
+            }
+        }
+
+        return seedResults;
+    }
+
+    //********************************************************************************
+    //                                Private methods
+    //********************************************************************************
+
+    ResultsHeader* ResultsStore::this_logHeader() const
+    {
+        return reinterpret_cast<ResultsHeader*>(m_log.getData());
+    }
+
+    bool ResultsStore::this_mapRecords(std::uint64_t t_recordCount)
+    {
+        return m_log.map(sizeof(ResultsHeader) + t_recordCount * sizeof(GameResult));
+    }
+
+    std::string ResultsStore::this_indexPath(bool b_isScoreIndex, std::uint64_t t_generation) const
+    {
+        return m_filePath + (b_isScoreIndex ? ".score." : ".seed.") + std::to_string(t_generation) + ".idx";
+    }
+
+    // Opens a published index, never creates one
+    bool ResultsStore::this_openIndex(MappedFile& t_index, const std::string& t_filePath)
+    {
+        if (!t_index.open(t_filePath, OPEN_EXISTING) || t_index.getFileSize() < sizeof(IndexHeader) || !t_index.map(t_index.getFileSize()))
+        {
+            t_index.close();
+            return false;
+        }
+
+        const IndexHeader* header = reinterpret_cast<const IndexHeader*>(t_index.getData());
+        if (header->magic != INDEX_MAGIC || sizeof(IndexHeader) + header->entryCount * sizeof(IndexEntry) > t_index.getMappedSize())
+        {
+            t_index.close();
+            return false;
+        }
+
+        return true;
+    }
+
+    // Follows the generation published in the log header
+    bool ResultsStore::this_refreshIndex()
+    {
+        constexpr int OPEN_ATTEMPTS = 3;
+
+        for (int attempt = 0; attempt < OPEN_ATTEMPTS; attempt++)
+        {
+            std::uint64_t generation = static_cast<std::uint64_t>(this_logHeader()->indexGeneration);
+            if (generation == m_indexGeneration)
+            {
+                return true;
+            }
+
+            m_scoreIndex.close();
+            m_seedIndex.close();
+            m_indexGeneration = 0;
+
+            if (generation == 0)
+            {
+                return true;
+            }
+
+            // A newer generation may have been published and this one deleted meanwhile, try again then
+            if (this_openIndex(m_scoreIndex, this_indexPath(true, generation)) &&
+                this_openIndex(m_seedIndex, this_indexPath(false, generation)))
+            {
+                m_indexGeneration = generation;
+                return true;
+            }
+
+            m_scoreIndex.close();
+            m_seedIndex.close();
+        }
+
+        return false;
+    }
+
+    // Copies the published entries, then sorts only the new records behind them and merges
+    bool ResultsStore::this_buildIndex(MappedFile& t_newIndex, MappedFile& t_oldIndex, std::uint64_t t_indexedCount,
+        std::uint64_t t_recordCount, bool b_isScoreIndex, std::uint64_t t_generation)
+    {
+        if (!t_newIndex.open(this_indexPath(b_isScoreIndex, t_generation), CREATE_ALWAYS) ||
+            !t_newIndex.map(sizeof(IndexHeader) + t_recordCount * sizeof(IndexEntry)) ||
+            !this_mapRecords(t_recordCount))
+        {
+            return false;
+        }
+
+        const GameResult* records = reinterpret_cast<const GameResult*>(m_log.getData() + sizeof(ResultsHeader));
+        IndexEntry* entries = reinterpret_cast<IndexEntry*>(t_newIndex.getData() + sizeof(IndexHeader));
+
+        if (t_indexedCount > 0)
+        {
+            const IndexEntry* oldEntries = reinterpret_cast<const IndexEntry*>(t_oldIndex.getData() + sizeof(IndexHeader));
+            std::copy(oldEntries, oldEntries + t_indexedCount, entries);
+        }
+
+        for (std::uint64_t recordNumber = t_indexedCount; recordNumber < t_recordCount; recordNumber++)
+        {
+            std::int64_t key = b_isScoreIndex ? records[recordNumber].score : static_cast<std::int64_t>(records[recordNumber].seed);
+            entries[recordNumber] = { key, recordNumber };
+        }
+
+        std::sort(entries + t_indexedCount, entries + t_recordCount, IsBefore);
+        std::inplace_merge(entries, entries + t_indexedCount, entries + t_recordCount, IsBefore);
+
+        IndexHeader* header = reinterpret_cast<IndexHeader*>(t_newIndex.getData());
+        header->magic = INDEX_MAGIC;
+        header->entryCount = t_recordCount;
+
+        return true;
+    }
+
+    // Deletes every generation below the published one, stops at the first that can't be deleted yet
+    void ResultsStore::this_deleteOldIndexes()
+    {
+        ResultsHeader* header = this_logHeader();
+        std::uint64_t generation = (header->oldestGeneration == 0) ? 1 : header->oldestGeneration;
+
+        for (; generation < m_indexGeneration; generation++)
+        {
+            bool b_isScoreDeleted = DeleteFileA(this_indexPath(true, generation).c_str()) || GetLastError() == ERROR_FILE_NOT_FOUND;
+            bool b_isSeedDeleted = DeleteFileA(this_indexPath(false, generation).c_str()) || GetLastError() == ERROR_FILE_NOT_FOUND;
+
+            if (!b_isScoreDeleted || !b_isSeedDeleted)
+            {
+                break;
+            }
+        }
+        header->oldestGeneration = generation;
+
+        return;
+    }
+
+    std::uint64_t ResultsStore::this_entryCount(const MappedFile& t_index) const
+    {
+        return reinterpret_cast<const IndexHeader*>(t_index.getData())->entryCount;
+    }
+
+    bool ResultsStore::this_readIndexed(const MappedFile& t_index, std::uint64_t t_position, GameResult& t_result)
+    {
+        const IndexEntry* entries = reinterpret_cast<const IndexEntry*>(t_index.getData() + sizeof(IndexHeader));
+
+        return getRecord(entries[t_position].recordNumber, t_result);
+    }
+
+    // Returns true when the last owner died holding the mutex, it is still owned then
+    bool ResultsStore::this_lock(HANDLE t_lock)
+    {
+        return WaitForSingleObject(t_lock, INFINITE) == WAIT_ABANDONED;
+    }
+
+    void ResultsStore::this_unlock(HANDLE t_lock)
+    {
+        ReleaseMutex(t_lock);
+
+        return;
+    }
+
+} }
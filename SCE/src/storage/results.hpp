@@ -0,0 +1,169 @@
+#pragma once
+
+// (C) Stipl3x 2020
+
+/*
+ * The ResultsStore class keeps the results of finished games in an
+ * append-only log of fixed-size records, memory-mapped so that huge logs
+ * are paged in by the system instead of being loaded in memory.
+ * Several processes can append to the same log at the same time, every
+ * append is done while holding a named mutex derived from the log path.
+ *
+ * Two sorted index files live next to the log, one by score and one by
+ * seed, used for the top-N, percentile and per-seed queries.
+ * An index file is never changed once published. updateIndex() writes
+ * the next generation of both files, merging the published entries with
+ * the records appended since, and then publishes it by switching the
+ * generation in the log header. A builder dying half way only leaves
+ * unpublished files behind. Older generations are deleted by the next
+ * builders, the ones still open elsewhere as soon as they are closed.
+ * Index builders share a second named mutex,
+ * so appending never waits for an index to be built.
+ * The queries only see the records of the published generation.
+ *
+ * Log layout:   ResultsHeader, then GameResult records in appending order
+ * Index layout: IndexHeader, then IndexEntry entries sorted by key,
+ *               in <log>.score.<generation>.idx and <log>.seed.<generation>.idx
+ *
+ * GNU GPLv3
+ * (C) Stipl3x 2020
+ *
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <Windows.h>
+
+namespace SCE { namespace storage {
+
+    // One finished game, the size must never change for an existing log
+    struct GameResult
+    {
+        std::uint64_t seed;
+        std::int64_t durationMs;
+        std::int32_t score;
+        std::int32_t lines;
+        std::int32_t pieces;
+        std::uint32_t engineVersion;
+    };
+
+    struct ResultsHeader
+    {
+        std::uint64_t magic;
+        std::uint32_t recordSize;
+        std::uint32_t reserved;
+        volatile LONG64 recordCount; // Written last, readers never see half a record
+        std::uint64_t capacity;
+        volatile LONG64 indexGeneration; // 0 until the first index is published
+        std::uint64_t oldestGeneration; // Oldest generation whose files may still exist, 0 when unknown
+        char padding[16];
+    };
+
+    struct IndexEntry
+    {
+        std::int64_t key;
+        std::uint64_t recordNumber;
+    };
+
+    struct IndexHeader
+    {
+        std::uint64_t magic;
+        std::uint64_t entryCount;
+        char padding[48];
+    };
+
+    // A file mapped as a whole, growing the file when a bigger view is asked for
+    class MappedFile
+    {
+    public:
+        MappedFile(); // Constructor
+        ~MappedFile(); // Destructor
+
+        // The handles are owned, so the file can not be copied
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        //*****Public Methods*****
+        // Getters
+        char* getData() const;
+        std::uint64_t getMappedSize() const;
+        std::uint64_t getFileSize() const;
+
+        // File components - Windows
+        bool open(const std::string& t_filePath, DWORD t_creationDisposition = OPEN_ALWAYS);
+        void close();
+        bool map(std::uint64_t t_size);
+
+
+
+        //*****Only hidden class stuff*****
+    private:
+        //*****Private Variables*****
+        HANDLE m_file;
+        HANDLE m_mapping;
+        char* m_data;
+        std::uint64_t m_mappedSize;
+
+        //*****Private Methods*****
+        void this_unmap();
+    };
+
+    class ResultsStore
+    {
+    public:
+        ResultsStore(); // Constructor
+        ~ResultsStore(); // Destructor
+
+        ResultsStore(const ResultsStore&) = delete;
+        ResultsStore& operator=(const ResultsStore&) = delete;
+
+        //*****Public Methods*****
+        // Getters
+        bool isOpen() const;
+        std::uint64_t getRecordCount() const;
+        bool getRecord(std::uint64_t t_recordNumber, GameResult& t_result);
+
+        // Log functions
+        bool open(const std::string& t_filePath);
+        void close();
+        bool append(const GameResult& t_result);
+
+        // Index functions, the queries only see the records indexed so far
+        bool updateIndex();
+        std::vector<GameResult> getTopScores(int t_count);
+        bool getScoreAtPercentile(double t_percentile, int& t_score);
+        std::vector<GameResult> getResultsForSeed(std::uint64_t t_seed);
+
+
+
+        //*****Only hidden class stuff*****
+    private:
+        //*****Private Variables*****
+        MappedFile m_log;
+        MappedFile m_scoreIndex;
+        MappedFile m_seedIndex;
+
+        std::string m_filePath;
+        std::uint64_t m_indexGeneration;
+
+        // Named mutexes shared by every process using the same log
+        HANDLE m_lock;
+        HANDLE m_indexLock;
+
+        //*****Private Methods*****
+        ResultsHeader* this_logHeader() const;
+        bool this_mapRecords(std::uint64_t t_recordCount);
+        std::string this_indexPath(bool b_isScoreIndex, std::uint64_t t_generation) const;
+        bool this_openIndex(MappedFile& t_index, const std::string& t_filePath);
+        bool this_refreshIndex();
+        void this_deleteOldIndexes();
+        bool this_buildIndex(MappedFile& t_newIndex, MappedFile& t_oldIndex, std::uint64_t t_indexedCount,
+            std::uint64_t t_recordCount, bool b_isScoreIndex, std::uint64_t t_generation);
+        std::uint64_t this_entryCount(const MappedFile& t_index) const;
+        bool this_readIndexed(const MappedFile& t_index, std::uint64_t t_position, GameResult& t_result);
+        bool this_lock(HANDLE t_lock);
+        void this_unlock(HANDLE t_lock);
+    };
+
+} }
@@ -0,0 +1,154 @@
+// (C) Stipl3x 2020
+
+#include "PieceSet.hpp"
+
+#include <fstream>
+
+namespace {
+
+    bool IsBlock(char t_font)
+    {
+        return t_font != ' ' && t_font != '.' && t_font != '\t';
+    }
+
+    bool IsEmptyLine(const std::string& t_line)
+    {
+        for (char font : t_line)
+        {
+            if (font != ' ' && font != '\t')
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Turns the lines of one piece into its cells, moved to the top-left of a tight box
+    bool FinishPiece(const std::vector<std::string>& t_lines, int t_maxSize, std::vector<Piece>& t_pieceSet)
+    {
+        Piece piece = { 0, 0, ' ', {} };
+        int minX = 0, minY = 0, maxX = 0, maxY = 0;
+
+        for (int heightIndex = 0; heightIndex < static_cast<int>(t_lines.size()); heightIndex++)
+        {
+            for (int widthIndex = 0; widthIndex < static_cast<int>(t_lines[heightIndex].size()); widthIndex++)
+            {
+                char font = t_lines[heightIndex][widthIndex];
+                if (!IsBlock(font))
+                {
+                    continue;
+                }
+
+                if (piece.cells.empty())
+                {
+                    piece.font = font;
+                    minX = maxX = widthIndex;
+                    minY = maxY = heightIndex;
+                }
+
+                minX = (widthIndex < minX) ? widthIndex : minX;
+                maxX = (widthIndex > maxX) ? widthIndex : maxX;
+                minY = (heightIndex < minY) ? heightIndex : minY;
+                maxY = (heightIndex > maxY) ? heightIndex : maxY;
+
+                piece.cells.push_back({ widthIndex, heightIndex });
+            }
+        }
+
+        // Only dots, nothing to add
+        if (piece.cells.empty())
+        {
+            return true;
+        }
+
+        for (SCE::graphics::GameObjectCell& cell : piece.cells)
+        {
+            cell.x -= minX;
+            cell.y -= minY;
+        }
+        piece.width = maxX - minX + 1;
+        piece.height = maxY - minY + 1;
+
+        // Rotations swap the sides, so both have to fit
+        if (piece.width > t_maxSize || piece.height > t_maxSize)
+        {
+            return false;
+        }
+
+        t_pieceSet.push_back(piece);
+
+        return true;
+    }
+
+}
+
+bool LoadPieceSet(const std::string& t_filePath, int t_maxSize, std::vector<Piece>& t_pieceSet)
+{
+    std::ifstream pieceFile(t_filePath);
+    if (!pieceFile)
+    {
+        return false;
+    }
+
+    return ParsePieceSet(pieceFile, t_maxSize, t_pieceSet);
+}
+
+bool ParsePieceSet(std::istream& t_input, int t_maxSize, std::vector<Piece>& t_pieceSet)
+{
+    bool b_isValid = true;
+    std::vector<Piece> pieceSet;
+    std::vector<std::string> pieceLines;
+    std::string line;
+
+    while (std::getline(t_input, line))
+    {
+        // Files saved on Windows keep the carriage return
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+
+        if (line.compare(0, 2, "//") == 0)
+        {
+            continue;
+        }
+
+        if (IsEmptyLine(line))
+        {
+            b_isValid = FinishPiece(pieceLines, t_maxSize, pieceSet) && b_isValid;
+            pieceLines.clear();
+        }
+        else
+        {
+            pieceLines.push_back(line);
+        }
+    }
+    b_isValid = FinishPiece(pieceLines, t_maxSize, pieceSet) && b_isValid;
+
+    if (!b_isValid || pieceSet.empty())
+    {
+        return false;
+    }
+
+    t_pieceSet = pieceSet;
+
+    return true;
+}
+
+void RotatePiece(Piece& t_piece)
+{
+    // The top row becomes the right column
+    for (SCE::graphics::GameObjectCell& cell : t_piece.cells)
+    {
+        int oldX = cell.x;
+        cell.x = t_piece.height - 1 - cell.y;
+        cell.y = oldX;
+    }
+
+    int oldWidth = t_piece.width;
+    t_piece.width = t_piece.height;
+    t_piece.height = oldWidth;
+
+    return;
+}
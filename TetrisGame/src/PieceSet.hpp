@@ -0,0 +1,42 @@
+#pragma once
+
+// (C) Stipl3x 2020
+
+/*
+ * Piece sets for the Tetris Game. A piece is stored only as the list of
+ * its occupied cells, relative to the top-left of its tight bounding box,
+ * so checking or drawing it costs one step per block whatever its size.
+ *
+ * A piece set file describes one piece per block of lines, separated by
+ * empty lines. Any character other than ' ' or '.' is a block and the
+ * first one found is used as the piece font. Lines starting with "//" are
+ * comments. For example, the L shape:
+ *
+ *   .X
+ *   .X
+ *   .XX
+ *
+ * GNU GPLv3
+ * (C) Stipl3x 2020
+ */
+
+#include "graphics/graphics.hpp"
+
+#include <istream>
+#include <string>
+#include <vector>
+
+struct Piece
+{
+    int width;
+    int height;
+    char font;
+    std::vector<SCE::graphics::GameObjectCell> cells;
+};
+
+// Both return false when no piece was read or one is bigger than t_maxSize
+bool LoadPieceSet(const std::string& t_filePath, int t_maxSize, std::vector<Piece>& t_pieceSet);
+bool ParsePieceSet(std::istream& t_input, int t_maxSize, std::vector<Piece>& t_pieceSet);
+
+// Rotates clockwise inside the bounding box, which swaps width and height
+void RotatePiece(Piece& t_piece);
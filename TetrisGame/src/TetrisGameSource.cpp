@@ -10,7 +10,10 @@
  * Enjoy!:D
  */
 
-#include "graphics/graphics.hpp"
+#include "TetrisGameSource.hpp"
+#include <fstream>
+#include <random>
+#include <sstream>
 #include <time.h>
 
 // Console properties
@@ -21,72 +24,103 @@ constexpr int H_PADDING = 1;
 constexpr char BORDER_FONT = '#';
 
 // Game objects
-constexpr int SHAPE_WIDTH = 4;
-constexpr int SHAPE_HEIGHT = 4;
+constexpr int MAX_PIECE_SIZE = WIDTH - 2;
+const char* PIECE_SET_FILE = "pieces.txt";
+
+// Used when no piece set file is found, the classic seven shapes
+const char* DEFAULT_PIECE_SET =
+    "// L shape\n"
+    "XX\n"
+    "X.\n"
+    "X.\n"
+    "\n"
+    "// J shape\n"
+    "XX\n"
+    ".X\n"
+    ".X\n"
+    "\n"
+    "// I shape\n"
+    "X\n"
+    "X\n"
+    "X\n"
+    "X\n"
+    "\n"
+    "// Block shape\n"
+    "XX\n"
+    "XX\n"
+    "\n"
+    "// T shape\n"
+    "X.\n"
+    "XX\n"
+    "X.\n"
+    "\n"
+    "// 4 shape\n"
+    "X.\n"
+    "XX\n"
+    ".X\n"
+    "\n"
+    "// IDK shape :D\n"
+    ".X\n"
+    "XX\n"
+    "X.\n";
+
+std::vector<Piece> pieceSet;
+
+// Side of the box that fits every piece of the set, in any rotation
+int maxPieceSize = 0;
+
+// Game pace, a loop frame and a gravity step
+constexpr int FRAME_DELAY = 50;
+constexpr double GRAVITY_DELAY = 800.0;
 
 // Start position for a shape
-int currentXPostion = WIDTH / 2 - SHAPE_WIDTH / 2;
+int currentXPostion = WIDTH / 2;
 int currentYPosition = 1;
 
-char shapeAsset[7][16] = {  // L shape
-                           {' ', 'X', 'X', ' ',
-                            ' ', 'X', ' ', ' ',
-                            ' ', 'X', ' ', ' ',
-                            ' ', ' ', ' ', ' '},
-
-                            // J shape
-                           {' ', 'X', 'X', ' ',
-                            ' ', ' ', 'X', ' ',
-                            ' ', ' ', 'X', ' ',
-                            ' ', ' ', ' ', ' '},
-
-                            // I shape
-                           {' ', 'X', ' ', ' ',
-                            ' ', 'X', ' ', ' ',
-                            ' ', 'X', ' ', ' ',
-                            ' ', 'X', ' ', ' '},
-
-                            // Block shape
-                           {' ', 'X', 'X', ' ',
-                            ' ', 'X', 'X', ' ',
-                            ' ', ' ', ' ', ' ',
-                            ' ', ' ', ' ', ' '},
-
-                            // T shape
-                           {' ', 'X', ' ', ' ',
-                            ' ', 'X', 'X', ' ',
-                            ' ', 'X', ' ', ' ',
-                            ' ', ' ', ' ', ' '},
-
-                            // 4 shape
-                           {' ', 'X', ' ', ' ',
-                            ' ', 'X', 'X', ' ',
-                            ' ', ' ', 'X', ' ',
-                            ' ', ' ', ' ', ' '},
-
-                            // IDK shape :D
-                           {' ', ' ', 'X', ' ',
-                            ' ', 'X', 'X', ' ',
-                            ' ', 'X', ' ', ' ',
-                            ' ', ' ', ' ', ' '} };
+// State of the running game, kept between loop frames
+Piece currentShape;
+Piece futureShape;
+double lastUpdateMs = 0.0;
+double gravityMs = 0.0;
+int placedPieces = 0;
+double gameStartMs = 0.0;
+
+// State of the game over screen
+int gameOverBannerId = 0;
 
 // Game instance
 SCE::graphics::ConsoleEngine tetrisBoard;
 
-// Game loop functions
-bool WantsToStartNewGame();
-void StartNewGame();
-void RunGame();
-void EndGame();
+// Results of every game played, kept next to the game
+const char* RESULTS_FILE = "results.dat";
+SCE::storage::ResultsStore resultsStore;
+
+// Seed of the current game, the same seed replays the same sequence of pieces on every
+// platform, since the generator is fully specified by the standard unlike rand()
+unsigned int gameSeed = 0;
+std::mt19937 randomGenerator;
+
+void SaveResult(int t_pieces, DWORD t_durationMs);
+void RenderFrame(Piece& t_currentShape, Piece& t_futureShape);
+void RenderPendingFrame(Piece& t_currentShape, Piece& t_futureShape);
+void ProcessInput(Piece& t_currentShape, Piece& t_futureShape);
+void CreateRandomShape(Piece& t_shape);
+void RotateShape(Piece& t_currentShape);
+void SpawnShape(Piece& t_currentShape);
+void CheckInitSpaceFor(Piece& t_currentShape);
+
+#ifndef TETRIS_NO_MAIN
+int main(int argc, char* argv[])
+{
+    // A piece set file can be given as the first argument
+    if (!LoadPieces(argc > 1 ? argv[1] : PIECE_SET_FILE, argc > 1))
+    {
+        return 1;
+    }
 
-void ProcessInput(char* t_currentShape);
-void RotateShape(char* t_currentShape);
-void CopyShape(char* t_currentShape, char* t_shapeToBeCopied);
-bool CompareShapes(char* t_currentShape, char* t_shapeToBeCompared);
-void CheckInitSpaceFor(char* t_currentShape);
+    // The game is still playable when the results can't be kept
+    resultsStore.open(RESULTS_FILE);
 
-int main()
-{
     tetrisBoard.setCursorVisibility(false);
 
     // Game loop start
@@ -102,12 +136,24 @@ int main()
 
     SCE_CONSOLE_INPUT.get();
 }
+#endif
 
 bool WantsToStartNewGame()
 {
     tetrisBoard.clearConsoleScreen();
 
     SCE_CONSOLE_OUTPUT << "Your last score was: " << tetrisBoard.getMyScore() << SCE_CONSOLE_NEW_LINE;
+
+    // Index the games played since the last time and show the best one
+    if (resultsStore.updateIndex())
+    {
+        std::vector<SCE::storage::GameResult> bestResults = resultsStore.getTopScores(1);
+        if (!bestResults.empty())
+        {
+            SCE_CONSOLE_OUTPUT << "The best score is: " << bestResults[0].score << SCE_CONSOLE_NEW_LINE;
+        }
+    }
+
     SCE_CONSOLE_OUTPUT << "Press Enter key to start a new game...";
     
     // Wait for the user to press Enter
@@ -123,129 +169,216 @@ void StartNewGame()
     tetrisBoard.reset();
     tetrisBoard.createGameScreen(WIDTH, HEIGHT, W_PADDING, H_PADDING, BORDER_FONT);
 
+    // Generate a random seed every new game
+    gameSeed = static_cast<unsigned int>(time(0));
+
     return;
 }
 
 void RunGame()
 {
-    constexpr int NUMBER_OF_TICKS = 15;
+    BeginGame();
 
-    bool b_isRunning = true;
-    bool b_isTimeToUpdate = false;
+    while (UpdateGame());
 
-    int currentTick = 0;
+    FinishGame();
 
-    // Generate a random seed every new game
-    srand(time(0));
+    return;
+}
 
-    int randomShapeNumber = rand() % 7;
-    int randomRotator = rand() % 4;
-    char currentShape[16];
-    char futureShape[16];
+void BeginGame()
+{
+    placedPieces = 0;
+    gameStartMs = tetrisBoard.getTimeMs();
+    gravityMs = 0.0;
 
-    // Create the first random shape to use and apply a random rotation
-    CopyShape(currentShape, shapeAsset[randomShapeNumber]);
-    for (int rotateIndex = 0; rotateIndex < randomRotator; rotateIndex++)
-    {
-        RotateShape(currentShape);
-    }
-    
-    // Create the next random shape to use and apply a random rotation
-    randomShapeNumber = rand() % 7;
-    CopyShape(futureShape, shapeAsset[randomShapeNumber]);
-    for (int rotateIndex = 0; rotateIndex < randomRotator; rotateIndex++)
-    {
-        RotateShape(futureShape);
-    }
+    // The first loop frame counts for a whole frame delay, like every frame after it
+    lastUpdateMs = gameStartMs - FRAME_DELAY;
+
+    randomGenerator.seed(gameSeed);
+
+    // Create the first random shape to use and the next one
+    CreateRandomShape(currentShape);
+    CreateRandomShape(futureShape);
 
     // Make sure the shape is on the first line
-    CheckInitSpaceFor(currentShape);
+    SpawnShape(currentShape);
 
-    tetrisBoard.renderGameScreen();
-    tetrisBoard.renderGameObject(currentShape, SHAPE_WIDTH, SHAPE_HEIGHT, currentXPostion, currentYPosition);
-    tetrisBoard.displayFutureGameObject(futureShape, SHAPE_WIDTH, SHAPE_HEIGHT);
+    RenderFrame(currentShape, futureShape);
+
+    return;
+}
+
+// One loop frame of the game, returns false once the game is over
+bool UpdateGame()
+{
+    bool b_isRunning = true;
+    bool b_hasFallen = false;
+    double frameStartMs = tetrisBoard.getTimeMs();
 
-    while (b_isRunning)
+    ProcessInput(currentShape, futureShape);
+
+    // Gravity runs on the clock, not on loop frames. After a frame that took too long
+    // every step it missed is made up at once, so the game is not slowed down
+    gravityMs += frameStartMs - lastUpdateMs;
+    lastUpdateMs = frameStartMs;
+
+    while (b_isRunning && gravityMs >= GRAVITY_DELAY)
     {
-        if (currentTick++ >= NUMBER_OF_TICKS)
+        gravityMs -= GRAVITY_DELAY;
+        b_hasFallen = true;
+
+        // Game can continue
+        if (!tetrisBoard.isGoingToCollide(currentShape.cells.data(), static_cast<int>(currentShape.cells.size()), currentXPostion, currentYPosition + 1))
         {
-            b_isTimeToUpdate = true;
+            currentYPosition++;
         }
-
-        ProcessInput(currentShape);
-
-        if (b_isTimeToUpdate)
+        // Update game and add a new piece
+        else
         {
-            b_isTimeToUpdate = false;
-            currentTick = 0;
-
-            // Game can continue
-            if (!tetrisBoard.isGoingToCollide(currentShape, SHAPE_WIDTH, SHAPE_HEIGHT, currentXPostion, currentYPosition + 1))
+            // If a new piece was generated and it collides with the board, then end game
+            if (tetrisBoard.isGoingToCollide(currentShape.cells.data(), static_cast<int>(currentShape.cells.size()), currentXPostion, currentYPosition))
             {
-                currentYPosition++;
+                b_isRunning = false;
             }
-            // Update game and add a new piece
-            else
+
+            for (const SCE::graphics::GameObjectCell& cell : currentShape.cells)
             {
-                // If a new piece was generated and it collides with the board, then end game
-                if (tetrisBoard.isGoingToCollide(currentShape, SHAPE_WIDTH, SHAPE_HEIGHT, currentXPostion, currentYPosition))
-                {
-                    b_isRunning = false;
-                }
-
-                for (int heightIndex = 0; heightIndex < 4; heightIndex++)
-                {
-                    for (int widthIndex = 0; widthIndex < 4; widthIndex++)
-                    {
-                        tetrisBoard.changeAtPosition(currentXPostion + widthIndex, currentYPosition + heightIndex,
-                            currentShape[heightIndex * 4 + widthIndex]);
-                    }
-                }
-
-                tetrisBoard.checkForLines();
-
-                // Restart the position
-                currentXPostion = WIDTH / 2 - SHAPE_WIDTH / 2;
-                currentYPosition = 1;
-
-                // Update the current shape with the next shape
-                CopyShape(currentShape, futureShape);
-
-                // Create a new next shape and apply a random rotation
-                randomShapeNumber = rand() % 7;
-                CopyShape(futureShape, shapeAsset[randomShapeNumber]);
-                randomRotator = rand() % 4;
-                for (int rotateIndex = 0; rotateIndex < randomRotator; rotateIndex++)
-                {
-                    RotateShape(futureShape);
-                }
-
-                // Make sure it is on first line
-                CheckInitSpaceFor(currentShape);
+                tetrisBoard.changeAtPosition(currentXPostion + cell.x, currentYPosition + cell.y, currentShape.font);
             }
+            placedPieces++;
+
+            tetrisBoard.checkForLines();
 
-            tetrisBoard.renderGameScreen();
-            tetrisBoard.renderGameObject(currentShape, SHAPE_WIDTH, SHAPE_HEIGHT, currentXPostion, currentYPosition);
-            tetrisBoard.displayFutureGameObject(futureShape, SHAPE_WIDTH, SHAPE_HEIGHT);
+            // Update the current shape with the next shape
+            currentShape = futureShape;
+
+            // Create a new next shape
+            CreateRandomShape(futureShape);
+
+            // Restart the position and make sure it is on first line
+            SpawnShape(currentShape);
         }
+    }
 
-        // Delay for each loop frame
-        Sleep(50);
+    // Only the state after the last step is worth drawing
+    if (b_hasFallen)
+    {
+        RenderFrame(currentShape, futureShape);
     }
-    
+
+    // Playing effects need a new frame every loop frame
+    tetrisBoard.updateEffects();
+
+    // Catch up with a frame the pacing refused earlier
+    RenderPendingFrame(currentShape, futureShape);
+
+    // Delay for each loop frame, without the time already spent rendering.
+    // A single write slower than the delay still blocks the loop until it is done
+    tetrisBoard.waitFor(FRAME_DELAY - static_cast<int>(tetrisBoard.getTimeMs() - frameStartMs));
+
+    return b_isRunning;
+}
+
+void FinishGame()
+{
+    SaveResult(placedPieces, static_cast<DWORD>(tetrisBoard.getTimeMs() - gameStartMs));
+
     return;
 }
 
 void EndGame()
 {
-    tetrisBoard.clearConsoleScreen();
-    SCE_CONSOLE_OUTPUT << "GAME OVER!!! THANK YOU FOR PLAYING!!!";
-    Sleep(1000);
+    BeginGameOver();
+
+    while (UpdateGameOver());
+
+    return;
+}
+
+void BeginGameOver()
+{
+    constexpr int GAME_OVER_DURATION = 1000;
+
+    // Blink the message over the last board, Escape skips it
+    gameOverBannerId = tetrisBoard.playBanner("GAME OVER", GAME_OVER_DURATION);
+
+    return;
+}
+
+// One loop frame of the game over screen, returns false once the banner is over
+bool UpdateGameOver()
+{
+    if (!tetrisBoard.updateEffects())
+    {
+        return false;
+    }
+
+    if (tetrisBoard.isThisKeyPressed(VK_ESCAPE))
+    {
+        tetrisBoard.cancelEffect(gameOverBannerId);
+    }
+
+    // Same pacing as the game frames, the banner is not worth blocking a slow console
+    if (tetrisBoard.isTimeToRender())
+    {
+        tetrisBoard.beginFrame();
+        tetrisBoard.renderGameScreen();
+        tetrisBoard.endFrame();
+    }
+
+    tetrisBoard.waitFor(FRAME_DELAY);
+
+    return true;
+}
+
+void SaveResult(int t_pieces, DWORD t_durationMs)
+{
+    SCE::storage::GameResult result = {};
+    result.seed = gameSeed;
+    result.durationMs = t_durationMs;
+    result.score = tetrisBoard.getMyScore();
+    result.lines = tetrisBoard.getMyLines();
+    result.pieces = t_pieces;
+    result.engineVersion = SCE_ENGINE_VERSION;
+
+    resultsStore.append(result);
 
     return;
 }
 
-void ProcessInput(char* t_currentShape)
+// Asks for a frame of the new state and draws it when the pacing allows it.
+// On a slow console intermediate frames are skipped and only the latest state is drawn.
+void RenderFrame(Piece& t_currentShape, Piece& t_futureShape)
+{
+    tetrisBoard.requestFrame();
+    RenderPendingFrame(t_currentShape, t_futureShape);
+
+    return;
+}
+
+// Everything drawn between beginFrame and endFrame counts as one frame
+void RenderPendingFrame(Piece& t_currentShape, Piece& t_futureShape)
+{
+    if (!tetrisBoard.isTimeToRender())
+    {
+        return;
+    }
+
+    tetrisBoard.beginFrame();
+
+    tetrisBoard.renderGameScreen();
+    tetrisBoard.renderGameObject(t_currentShape.cells.data(), static_cast<int>(t_currentShape.cells.size()), t_currentShape.font,
+        currentXPostion, currentYPosition);
+    tetrisBoard.displayFutureGameObject(t_futureShape.cells.data(), static_cast<int>(t_futureShape.cells.size()), t_futureShape.font,
+        maxPieceSize, maxPieceSize);
+
+    tetrisBoard.endFrame();
+
+    return;
+}
+
+void ProcessInput(Piece& t_currentShape, Piece& t_futureShape)
 {
     constexpr int ROTATE_DELAY = 5;
 
@@ -258,7 +391,7 @@ void ProcessInput(char* t_currentShape)
     // Left move
     if (tetrisBoard.isThisKeyPressed('A') || tetrisBoard.isThisKeyPressed(VK_LEFT))
     {
-        if (!tetrisBoard.isGoingToCollide(t_currentShape, SHAPE_WIDTH, SHAPE_HEIGHT, currentXPostion - 1, currentYPosition))
+        if (!tetrisBoard.isGoingToCollide(t_currentShape.cells.data(), static_cast<int>(t_currentShape.cells.size()), currentXPostion - 1, currentYPosition))
         {
             currentXPostion--;
             b_newMove = true;
@@ -268,7 +401,7 @@ void ProcessInput(char* t_currentShape)
     // Right move
     else if (tetrisBoard.isThisKeyPressed('D') || tetrisBoard.isThisKeyPressed(VK_RIGHT))
     {
-        if(!tetrisBoard.isGoingToCollide(t_currentShape, SHAPE_WIDTH, SHAPE_HEIGHT, currentXPostion + 1, currentYPosition))
+        if(!tetrisBoard.isGoingToCollide(t_currentShape.cells.data(), static_cast<int>(t_currentShape.cells.size()), currentXPostion + 1, currentYPosition))
         {
             currentXPostion++;
             b_newMove = true;
@@ -278,7 +411,7 @@ void ProcessInput(char* t_currentShape)
     // Down move
     else if (tetrisBoard.isThisKeyPressed('S') || tetrisBoard.isThisKeyPressed(VK_DOWN))
     {
-        if (!tetrisBoard.isGoingToCollide(t_currentShape, SHAPE_WIDTH, SHAPE_HEIGHT, currentXPostion, currentYPosition + 1))
+        if (!tetrisBoard.isGoingToCollide(t_currentShape.cells.data(), static_cast<int>(t_currentShape.cells.size()), currentXPostion, currentYPosition + 1))
         {
             currentYPosition++;
             b_newMove = true;
@@ -297,70 +430,96 @@ void ProcessInput(char* t_currentShape)
 
     if (b_newMove)
     {
-        tetrisBoard.renderGameScreen();
-        tetrisBoard.renderGameObject(t_currentShape, SHAPE_WIDTH, SHAPE_HEIGHT, currentXPostion, currentYPosition);
+        RenderFrame(t_currentShape, t_futureShape);
     }
 
     return;
 }
 
-void RotateShape(char* t_currentShape)
+void CreateRandomShape(Piece& t_shape)
 {
-    char auxShape[16];
+    // Pick a random piece of the set and apply a random rotation
+    t_shape = pieceSet[randomGenerator() % pieceSet.size()];
 
-    // All cases, but the box
-    if (!CompareShapes(t_currentShape, shapeAsset[3]))
+    int randomRotator = static_cast<int>(randomGenerator() % 4);
+    for (int rotateIndex = 0; rotateIndex < randomRotator; rotateIndex++)
     {
-        // Create a copy
-        CopyShape(auxShape, t_currentShape);
+        RotatePiece(t_shape);
+    }
 
-        // Rotate the copy
-        for (int heightIndex = 0; heightIndex < SHAPE_HEIGHT; heightIndex++)
-        {
-            for (int widthIndex = 0; widthIndex < SHAPE_WIDTH; widthIndex++)
-            {
-                auxShape[heightIndex * SHAPE_HEIGHT + widthIndex] =
-                    t_currentShape[SHAPE_WIDTH * SHAPE_HEIGHT - (widthIndex + 1) * 4 + heightIndex];
-            }
-        }
+    return;
+}
 
-        // If it is ok to rotate, then update the current shape
-        if (!tetrisBoard.isGoingToCollide(auxShape, SHAPE_WIDTH, SHAPE_HEIGHT, currentXPostion, currentYPosition))
-        {
-            CopyShape(t_currentShape, auxShape);
-        }
+void RotateShape(Piece& t_currentShape)
+{
+    // Rotate a copy
+    Piece auxShape = t_currentShape;
+    RotatePiece(auxShape);
+
+    // Keep the rotated box centered on the old one
+    int rotatedXPosition = currentXPostion + (t_currentShape.width - auxShape.width) / 2;
+    int rotatedYPosition = currentYPosition + (t_currentShape.height - auxShape.height) / 2;
+
+    // If it is ok to rotate, then update the current shape
+    if (!tetrisBoard.isGoingToCollide(auxShape.cells.data(), static_cast<int>(auxShape.cells.size()), rotatedXPosition, rotatedYPosition))
+    {
+        t_currentShape = auxShape;
+        currentXPostion = rotatedXPosition;
+        currentYPosition = rotatedYPosition;
     }
 
     return;
 }
 
-void CopyShape(char* t_currentShape, char* t_shapeToBeCopied)
+void SpawnShape(Piece& t_currentShape)
+{
+    currentXPostion = WIDTH / 2 - t_currentShape.width / 2;
+    currentYPosition = 1;
+
+    CheckInitSpaceFor(t_currentShape);
+
+    return;
+}
+
+void CheckInitSpaceFor(Piece& t_currentShape)
 {
-    for (int index = 0; index < SHAPE_WIDTH * SHAPE_HEIGHT; index++)
+    while (!tetrisBoard.isGoingToCollide(t_currentShape.cells.data(), static_cast<int>(t_currentShape.cells.size()), currentXPostion, currentYPosition - 1))
     {
-        t_currentShape[index] = t_shapeToBeCopied[index];
+        currentYPosition--;
     }
+
+    return;
 }
 
-bool CompareShapes(char* t_currentShape, char* t_shapeToBeCompared)
+bool LoadPieces(const char* t_filePath, bool b_isRequired)
 {
-    for (int index = 0; index < SHAPE_WIDTH * SHAPE_HEIGHT; index++)
+    pieceSet.clear();
+    maxPieceSize = 0;
+
+    if (t_filePath == nullptr)
+    {
+        std::istringstream defaultPieceSet(DEFAULT_PIECE_SET);
+        ParsePieceSet(defaultPieceSet, MAX_PIECE_SIZE, pieceSet);
+    }
+    else if (!LoadPieceSet(t_filePath, MAX_PIECE_SIZE, pieceSet))
     {
-        if (t_currentShape[index] != t_shapeToBeCompared[index])
+        // A missing default file is fine, the classic shapes are used instead
+        std::ifstream pieceFile(t_filePath);
+        if (b_isRequired || pieceFile)
         {
+            SCE_CONSOLE_OUTPUT << "Error loading the piece set " << t_filePath << "!\n";
             return false;
         }
-    }
 
-    return true;
-}
+        std::istringstream defaultPieceSet(DEFAULT_PIECE_SET);
+        ParsePieceSet(defaultPieceSet, MAX_PIECE_SIZE, pieceSet);
+    }
 
-void CheckInitSpaceFor(char* t_currentShape)
-{
-    while (!tetrisBoard.isGoingToCollide(t_currentShape, SHAPE_WIDTH, SHAPE_HEIGHT, currentXPostion, currentYPosition - 1))
+    for (const Piece& piece : pieceSet)
     {
-        currentYPosition--;
+        maxPieceSize = (piece.width > maxPieceSize) ? piece.width : maxPieceSize;
+        maxPieceSize = (piece.height > maxPieceSize) ? piece.height : maxPieceSize;
     }
 
-    return;
+    return true;
 }
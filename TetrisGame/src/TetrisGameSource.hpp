@@ -0,0 +1,39 @@
+#pragma once
+
+// (C) Stipl3x 2020
+
+/*
+ * Tetris Game loop functions, shared with the replay harness which drives
+ * the game one loop frame at a time. Build with TETRIS_NO_MAIN to link the
+ * game into another program.
+ *
+ * GNU GPLv3
+ * (C) Stipl3x 2020
+ */
+
+#include "graphics/graphics.hpp"
+#include "storage/results.hpp"
+#include "PieceSet.hpp"
+
+// Game instance
+extern SCE::graphics::ConsoleEngine tetrisBoard;
+extern SCE::storage::ResultsStore resultsStore;
+extern unsigned int gameSeed;
+
+// Game loop functions
+bool WantsToStartNewGame();
+void StartNewGame();
+void RunGame();
+void EndGame();
+
+// RunGame split in steps, UpdateGame returns false once the game is over
+void BeginGame();
+bool UpdateGame();
+void FinishGame();
+
+// EndGame split in steps, UpdateGameOver returns false once the banner is over
+void BeginGameOver();
+bool UpdateGameOver();
+
+// Without a file path the classic shapes are used
+bool LoadPieces(const char* t_filePath, bool b_isRequired);
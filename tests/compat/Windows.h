@@ -0,0 +1,229 @@
+#pragma once
+
+// (C) Stipl3x 2020
+
+/*
+ * The part of Windows.h used by the engine, for building the replay
+ * harness on POSIX systems. The console calls do nothing, since the
+ * harness captures the output in a VirtualTerminal and scripts the input,
+ * and the file mapping calls are done with mmap. Named mutexes are not
+ * shared between processes, the harness only runs one.
+ * Never used on Windows, where the real header is found first.
+ *
+ * GNU GPLv3
+ * (C) Stipl3x 2020
+ *
+ */
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef void* HANDLE;
+typedef int BOOL;
+typedef unsigned long DWORD;
+typedef short SHORT;
+typedef long long LONG64;
+typedef std::size_t SIZE_T;
+
+typedef union
+{
+    long long QuadPart;
+} LARGE_INTEGER;
+
+struct COORD
+{
+    SHORT X;
+    SHORT Y;
+};
+
+struct CONSOLE_CURSOR_INFO
+{
+    DWORD dwSize;
+    BOOL bVisible;
+};
+
+#define FALSE 0
+#define TRUE 1
+#define MAX_PATH 260
+#define INFINITE 0xFFFFFFFF
+#define INVALID_HANDLE_VALUE ((HANDLE)(std::intptr_t)-1)
+
+#define STD_OUTPUT_HANDLE ((DWORD)-11)
+
+#define VK_RETURN 0x0D
+#define VK_ESCAPE 0x1B
+#define VK_SPACE 0x20
+#define VK_LEFT 0x25
+#define VK_UP 0x26
+#define VK_RIGHT 0x27
+#define VK_DOWN 0x28
+
+#define GENERIC_READ 0x80000000
+#define GENERIC_WRITE 0x40000000
+#define FILE_SHARE_READ 0x1
+#define FILE_SHARE_WRITE 0x2
+#define FILE_SHARE_DELETE 0x4
+#define CREATE_ALWAYS 2
+#define OPEN_EXISTING 3
+#define OPEN_ALWAYS 4
+#define FILE_ATTRIBUTE_NORMAL 0x80
+#define PAGE_READWRITE 0x04
+#define FILE_MAP_ALL_ACCESS 0xF001F
+
+#define WAIT_OBJECT_0 0x0
+#define WAIT_ABANDONED 0x80
+
+#define ERROR_FILE_NOT_FOUND 2
+
+// Console components
+inline HANDLE GetStdHandle(DWORD) { return nullptr; }
+inline BOOL SetConsoleCursorInfo(HANDLE, const CONSOLE_CURSOR_INFO*) { return TRUE; }
+inline BOOL SetConsoleCursorPosition(HANDLE, COORD) { return TRUE; }
+inline SHORT GetAsyncKeyState(int) { return 0; }
+
+// Time components
+inline void Sleep(DWORD t_durationMs)
+{
+    timespec duration = { static_cast<time_t>(t_durationMs / 1000), static_cast<long>(t_durationMs % 1000) * 1000000L };
+    nanosleep(&duration, nullptr);
+}
+
+inline DWORD GetTickCount()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<DWORD>(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+// File components, a file handle and a mapping handle both keep the descriptor
+struct CompatHandle
+{
+    int fileDescriptor;
+    bool b_isFile;
+};
+
+inline std::map<void*, SIZE_T>& CompatViews()
+{
+    // Never destroyed, views may still be unmapped by static destructors
+    static std::map<void*, SIZE_T>* views = new std::map<void*, SIZE_T>();
+    return *views;
+}
+
+inline HANDLE CreateFileA(const char* t_filePath, DWORD, DWORD, void*, DWORD t_creationDisposition, DWORD, void*)
+{
+    int flags = O_RDWR;
+    flags |= (t_creationDisposition == OPEN_EXISTING) ? 0 : O_CREAT;
+    flags |= (t_creationDisposition == CREATE_ALWAYS) ? O_TRUNC : 0;
+
+    int fileDescriptor = open(t_filePath, flags, 0644);
+    if (fileDescriptor < 0)
+    {
+        return INVALID_HANDLE_VALUE;
+    }
+
+    return new CompatHandle{ fileDescriptor, true };
+}
+
+inline BOOL GetFileSizeEx(HANDLE t_file, LARGE_INTEGER* t_size)
+{
+    struct stat fileStatus;
+    if (fstat(static_cast<CompatHandle*>(t_file)->fileDescriptor, &fileStatus) != 0)
+    {
+        return FALSE;
+    }
+
+    t_size->QuadPart = fileStatus.st_size;
+    return TRUE;
+}
+
+// Like Windows, the file grows to the size of the mapping
+inline HANDLE CreateFileMappingA(HANDLE t_file, void*, DWORD, DWORD t_sizeHigh, DWORD t_sizeLow, const char*)
+{
+    std::uint64_t size = (static_cast<std::uint64_t>(t_sizeHigh) << 32) | t_sizeLow;
+    int fileDescriptor = static_cast<CompatHandle*>(t_file)->fileDescriptor;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(t_file, &fileSize))
+    {
+        return nullptr;
+    }
+    if (static_cast<std::uint64_t>(fileSize.QuadPart) < size && ftruncate(fileDescriptor, static_cast<off_t>(size)) != 0)
+    {
+        return nullptr;
+    }
+
+    return new CompatHandle{ fileDescriptor, false };
+}
+
+inline void* MapViewOfFile(HANDLE t_mapping, DWORD, DWORD, DWORD, SIZE_T t_size)
+{
+    void* view = mmap(nullptr, t_size, PROT_READ | PROT_WRITE, MAP_SHARED, static_cast<CompatHandle*>(t_mapping)->fileDescriptor, 0);
+    if (view == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    CompatViews()[view] = t_size;
+    return view;
+}
+
+inline BOOL UnmapViewOfFile(const void* t_view)
+{
+    void* view = const_cast<void*>(t_view);
+    munmap(view, CompatViews()[view]);
+    CompatViews().erase(view);
+    return TRUE;
+}
+
+inline BOOL DeleteFileA(const char* t_filePath) { return unlink(t_filePath) == 0; }
+
+// Only tells a missing file apart from the other errors
+inline DWORD GetLastError() { return (errno == ENOENT) ? ERROR_FILE_NOT_FOUND : static_cast<DWORD>(errno); }
+
+// A file that does not exist yet keeps the path it was given
+inline DWORD GetFullPathNameA(const char* t_filePath, DWORD t_bufferSize, char* t_buffer, char**)
+{
+    char* fullPath = realpath(t_filePath, nullptr);
+    const char* path = (fullPath != nullptr) ? fullPath : t_filePath;
+
+    DWORD length = static_cast<DWORD>(std::strlen(path));
+    if (length < t_bufferSize)
+    {
+        std::strcpy(t_buffer, path);
+    }
+    std::free(fullPath);
+
+    return (length < t_bufferSize) ? length : 0;
+}
+
+// Synchronization components
+inline HANDLE CreateMutexA(void*, BOOL, const char*) { return new CompatHandle{ -1, false }; }
+inline DWORD WaitForSingleObject(HANDLE, DWORD) { return WAIT_OBJECT_0; }
+inline BOOL ReleaseMutex(HANDLE) { return TRUE; }
+
+inline BOOL CloseHandle(HANDLE t_handle)
+{
+    CompatHandle* handle = static_cast<CompatHandle*>(t_handle);
+    if (handle->b_isFile)
+    {
+        close(handle->fileDescriptor);
+    }
+    delete handle;
+    return TRUE;
+}
+
+inline LONG64 InterlockedExchange64(volatile LONG64* t_target, LONG64 t_value)
+{
+    return __atomic_exchange_n(t_target, t_value, __ATOMIC_SEQ_CST);
+}
+
+inline void MemoryBarrier() { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
@@ -0,0 +1,349 @@
+// (C) Stipl3x 2020
+
+/*
+ * Replay harness for the Tetris Game. It plays a seeded game from a
+ * scenario file, one loop frame per tick, with the output captured in a
+ * VirtualTerminal, the keyboard replaced by an InputScript and the engine
+ * on a manual clock, so the same scenario always draws the same screens.
+ * Once the game is over, the ticks left play the game over screen.
+ * The screen captured at the chosen ticks is compared with its golden file,
+ * and the biggest frame of the game must stay within the output budget.
+ *
+ * Usage: ReplayHarness <scenario file> [--update] [--frames]
+ *   --update  writes the golden files instead of comparing them
+ *   --frames  prints the frames rendered on every tick
+ *
+ * Scenario file, one command per line, "//" starts a comment:
+ *   seed <seed>                       seed of the game
+ *   ticks <count>                     loop frames to play
+ *   pieces <file>                     piece set, relative to the scenario, classic shapes without it
+ *   press <first> <last> <key>        key held from the first to the last tick, both included
+ *   capture <tick>                    screen compared with <scenario>.<tick>.golden after the tick
+ *   budget <bytes> <cursor moves>     most output a single frame may emit
+ *   console <ms per byte> <ms per move>  plays a slow console, every write takes time on the clock
+ *   minimal <tick>                    minimal-update mode must be on after the tick
+ *   dropped <count>                   frames the pacing must have dropped by the end of the game
+ *   lines <count>                     lines the game must have cleared by the end
+ *   headless                          plays without output, no effect may play and nothing may be written
+ *
+ * GNU GPLv3
+ * (C) Stipl3x 2020
+ */
+
+#include "TetrisGameSource.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+
+// Console properties, big enough for the playground and the texts next to it
+constexpr int TERMINAL_WIDTH = 40;
+constexpr int TERMINAL_HEIGHT = 25;
+
+struct Scenario
+{
+    unsigned int seed;
+    int ticks;
+    std::string piecesPath;
+    std::set<int> captureTicks;
+    int budgetBytes;
+    int budgetCursorMoves;
+    double msPerByte;
+    double msPerCursorMove;
+    std::set<int> minimalTicks;
+    int droppedFrames;
+    int lines;
+    bool isHeadless;
+};
+
+bool LoadScenario(const std::string& t_filePath, Scenario& t_scenario, SCE::graphics::InputScript& t_input);
+std::string GetGoldenPath(const std::string& t_scenarioPath, int t_tick);
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: ReplayHarness <scenario file> [--update] [--frames]\n";
+        return 2;
+    }
+
+    std::string scenarioPath = argv[1];
+    bool b_isUpdate = false;
+    bool b_isPrintingFrames = false;
+    for (int argIndex = 2; argIndex < argc; argIndex++)
+    {
+        b_isUpdate = b_isUpdate || std::string(argv[argIndex]) == "--update";
+        b_isPrintingFrames = b_isPrintingFrames || std::string(argv[argIndex]) == "--frames";
+    }
+
+    Scenario scenario;
+    SCE::graphics::InputScript input;
+    if (!LoadScenario(scenarioPath, scenario, input))
+    {
+        return 2;
+    }
+
+    if (!LoadPieces(scenario.piecesPath.empty() ? nullptr : scenario.piecesPath.c_str(), true))
+    {
+        return 2;
+    }
+
+    SCE::graphics::VirtualTerminal terminal(TERMINAL_WIDTH, TERMINAL_HEIGHT);
+    terminal.setWriteCosts(scenario.msPerByte, scenario.msPerCursorMove);
+    tetrisBoard.attachTerminal(&terminal);
+    tetrisBoard.attachInput(&input);
+    tetrisBoard.setManualClock(true);
+    tetrisBoard.setHeadless(scenario.isHeadless);
+
+    StartNewGame();
+    gameSeed = scenario.seed;
+    BeginGame();
+
+    bool b_isPassing = true;
+    bool b_isGameOver = false;
+    int lastFrameCount = tetrisBoard.getFrameCount();
+    int lastTick = -1;
+
+    for (int tick = 0; tick < scenario.ticks; tick++)
+    {
+        input.setTick(tick);
+
+        if (!b_isGameOver)
+        {
+            if (!UpdateGame())
+            {
+                FinishGame();
+                BeginGameOver();
+                b_isGameOver = true;
+            }
+        }
+        else if (!UpdateGameOver())
+        {
+            break;
+        }
+        lastTick = tick;
+
+        if (b_isPrintingFrames && tetrisBoard.getFrameCount() != lastFrameCount)
+        {
+            std::cout << "tick " << tick << ": " << tetrisBoard.getFrameCount() - lastFrameCount << " frame(s), last one "
+                << tetrisBoard.getLastFrameBytes() << " bytes, " << tetrisBoard.getLastFrameCursorMoves() << " cursor moves"
+                << (tetrisBoard.isMinimalUpdateMode() ? ", minimal update" : "") << "\n";
+        }
+        lastFrameCount = tetrisBoard.getFrameCount();
+
+        if (scenario.captureTicks.count(tick) > 0)
+        {
+            std::string goldenPath = GetGoldenPath(scenarioPath, tick);
+
+            if (b_isUpdate)
+            {
+                if (!terminal.saveScreen(goldenPath))
+                {
+                    std::cerr << "Can't write " << goldenPath << "\n";
+                    b_isPassing = false;
+                }
+            }
+            else if (!terminal.matchesScreen(goldenPath))
+            {
+                std::cerr << "Tick " << tick << " does not match " << goldenPath << ", the screen was:\n" << terminal.getScreen();
+                b_isPassing = false;
+            }
+        }
+
+        if (scenario.minimalTicks.count(tick) > 0 && !tetrisBoard.isMinimalUpdateMode())
+        {
+            std::cerr << "Tick " << tick << " is not in minimal-update mode\n";
+            b_isPassing = false;
+        }
+
+        if (scenario.isHeadless && tetrisBoard.hasEffects())
+        {
+            std::cerr << "Tick " << tick << " plays an effect in a headless game\n";
+            b_isPassing = false;
+        }
+    }
+
+    if (!b_isGameOver)
+    {
+        FinishGame();
+    }
+
+    // A capture after the end of the game would silently compare nothing
+    if (!scenario.captureTicks.empty() && *scenario.captureTicks.rbegin() > lastTick)
+    {
+        std::cerr << "The replay ended on tick " << lastTick << ", before the capture on tick " << *scenario.captureTicks.rbegin() << "\n";
+        b_isPassing = false;
+    }
+
+    if (!scenario.minimalTicks.empty() && *scenario.minimalTicks.rbegin() > lastTick)
+    {
+        std::cerr << "The replay ended on tick " << lastTick << ", before the check on tick " << *scenario.minimalTicks.rbegin() << "\n";
+        b_isPassing = false;
+    }
+
+    if (tetrisBoard.getDroppedFrames() != scenario.droppedFrames)
+    {
+        std::cerr << tetrisBoard.getDroppedFrames() << " frames were dropped, " << scenario.droppedFrames << " expected\n";
+        b_isPassing = false;
+    }
+
+    if (scenario.lines >= 0 && tetrisBoard.getMyLines() != scenario.lines)
+    {
+        std::cerr << tetrisBoard.getMyLines() << " lines were cleared, " << scenario.lines << " expected\n";
+        b_isPassing = false;
+    }
+
+    // Not even the first frame may reach the terminal
+    SCE::graphics::VirtualTerminal blankTerminal(TERMINAL_WIDTH, TERMINAL_HEIGHT);
+    if (scenario.isHeadless && (tetrisBoard.getPeakFrameBytes() > 0 || terminal.getScreen() != blankTerminal.getScreen()))
+    {
+        std::cerr << "A headless game wrote to the terminal, the screen was:\n" << terminal.getScreen();
+        b_isPassing = false;
+    }
+
+    std::cout << scenarioPath << ": " << lastTick + 1 << " ticks" << (b_isGameOver ? " until the game over" : "") << ", "
+        << tetrisBoard.getFrameCount() << " frames, " << tetrisBoard.getDroppedFrames() << " dropped, " << tetrisBoard.getMyLines() << " lines\n";
+    std::cout << "Biggest frame: " << tetrisBoard.getPeakFrameBytes() << " bytes (budget " << scenario.budgetBytes << "), "
+        << tetrisBoard.getPeakFrameCursorMoves() << " cursor moves (budget " << scenario.budgetCursorMoves << ")\n";
+
+    // The budget only ever goes down, raise it in the scenario on purpose
+    if (tetrisBoard.getPeakFrameBytes() > scenario.budgetBytes || tetrisBoard.getPeakFrameCursorMoves() > scenario.budgetCursorMoves)
+    {
+        std::cerr << "A frame went over the output budget\n";
+        b_isPassing = false;
+    }
+
+    std::cout << (b_isPassing ? "PASSED" : "FAILED") << "\n";
+
+    return b_isPassing ? 0 : 1;
+}
+
+bool LoadScenario(const std::string& t_filePath, Scenario& t_scenario, SCE::graphics::InputScript& t_input)
+{
+    std::ifstream scenarioFile(t_filePath);
+    if (!scenarioFile)
+    {
+        std::cerr << "Error loading the scenario " << t_filePath << "!\n";
+        return false;
+    }
+
+    t_scenario.seed = 0;
+    t_scenario.ticks = 0;
+    t_scenario.piecesPath.clear();
+    t_scenario.captureTicks.clear();
+    t_scenario.budgetBytes = 0;
+    t_scenario.budgetCursorMoves = 0;
+    t_scenario.msPerByte = 0.0;
+    t_scenario.msPerCursorMove = 0.0;
+    t_scenario.minimalTicks.clear();
+    t_scenario.droppedFrames = 0;
+    t_scenario.lines = -1;
+    t_scenario.isHeadless = false;
+
+    // Files given in the scenario are next to it
+    std::string directory;
+    std::size_t separator = t_filePath.find_last_of("/\\");
+    if (separator != std::string::npos)
+    {
+        directory = t_filePath.substr(0, separator + 1);
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(scenarioFile, line))
+    {
+        lineNumber++;
+
+        // Files saved on Windows keep the carriage return
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+
+        std::istringstream lineStream(line);
+        std::string command;
+        if (!(lineStream >> command) || command.compare(0, 2, "//") == 0)
+        {
+            continue;
+        }
+
+        bool b_isValid = false;
+        if (command == "seed")
+        {
+            b_isValid = static_cast<bool>(lineStream >> t_scenario.seed);
+        }
+        else if (command == "ticks")
+        {
+            b_isValid = static_cast<bool>(lineStream >> t_scenario.ticks);
+        }
+        else if (command == "pieces")
+        {
+            std::string piecesFile;
+            b_isValid = static_cast<bool>(lineStream >> piecesFile);
+            t_scenario.piecesPath = directory + piecesFile;
+        }
+        else if (command == "press")
+        {
+            int firstTick = 0;
+            int lastTick = 0;
+            std::string keyName;
+            b_isValid = (lineStream >> firstTick >> lastTick >> keyName) && t_input.press(firstTick, lastTick, keyName);
+        }
+        else if (command == "capture")
+        {
+            int tick = 0;
+            b_isValid = static_cast<bool>(lineStream >> tick);
+            t_scenario.captureTicks.insert(tick);
+        }
+        else if (command == "budget")
+        {
+            b_isValid = static_cast<bool>(lineStream >> t_scenario.budgetBytes >> t_scenario.budgetCursorMoves);
+        }
+        else if (command == "console")
+        {
+            b_isValid = static_cast<bool>(lineStream >> t_scenario.msPerByte >> t_scenario.msPerCursorMove);
+        }
+        else if (command == "minimal")
+        {
+            int tick = 0;
+            b_isValid = static_cast<bool>(lineStream >> tick);
+            t_scenario.minimalTicks.insert(tick);
+        }
+        else if (command == "dropped")
+        {
+            b_isValid = static_cast<bool>(lineStream >> t_scenario.droppedFrames);
+        }
+        else if (command == "lines")
+        {
+            b_isValid = static_cast<bool>(lineStream >> t_scenario.lines);
+        }
+        else if (command == "headless")
+        {
+            t_scenario.isHeadless = true;
+            b_isValid = true;
+        }
+
+        if (!b_isValid)
+        {
+            std::cerr << t_filePath << ":" << lineNumber << ": can't read \"" << line << "\"\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// The golden files sit next to the scenario, one per captured tick
+std::string GetGoldenPath(const std::string& t_scenarioPath, int t_tick)
+{
+    std::string basePath = t_scenarioPath;
+    std::size_t extension = basePath.find_last_of('.');
+    if (extension != std::string::npos && basePath.find_first_of("/\\", extension) == std::string::npos)
+    {
+        basePath.erase(extension);
+    }
+
+    return basePath + "." + std::to_string(t_tick) + ".golden";
+}
@@ -0,0 +1,278 @@
+// (C) Stipl3x 2020
+
+/*
+ * Checks the ResultsStore on a log created from scratch: appending past
+ * the first capacity of the log, incremental index updates, the top-N,
+ * percentile and per-seed queries, reopening an existing log and the
+ * deletion of the old index generations.
+ * Record number N of the test log is given the duration N, so every
+ * result read back tells which record it came from.
+ *
+ * Usage: ResultsStoreTest <log file>
+ *   the log and its index files are deleted first and once the test passes
+ *
+ * GNU GPLv3
+ * (C) Stipl3x 2020
+ */
+
+#include "storage/results.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Records the log has room for when it is created, INITIAL_CAPACITY in results.cpp
+constexpr int INITIAL_CAPACITY = 4096;
+
+// Records appended before the first index, enough to grow the log once
+constexpr int FIRST_RECORDS = INITIAL_CAPACITY + 100;
+constexpr int SEED_COUNT = 7;
+constexpr int SCORE_COUNT = 100;
+
+bool b_isPassing = true;
+
+void Check(bool b_condition, const std::string& t_description);
+bool FileExists(const std::string& t_filePath);
+std::string IndexPath(const std::string& t_logPath, const char* t_indexType, int t_generation);
+SCE::storage::GameResult MakeResult(int t_recordNumber, int t_score);
+
+void TestAppend(SCE::storage::ResultsStore& t_store);
+void TestIndexUpdate(SCE::storage::ResultsStore& t_store, const std::string& t_logPath);
+void TestTopScores(SCE::storage::ResultsStore& t_store);
+void TestPercentiles(SCE::storage::ResultsStore& t_store);
+void TestSeedLookup(SCE::storage::ResultsStore& t_store);
+void TestReopen(SCE::storage::ResultsStore& t_store, const std::string& t_logPath);
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: ResultsStoreTest <log file>\n";
+        return 2;
+    }
+
+    // A new log starts again from the first generation, older index files get overwritten
+    std::string logPath = argv[1];
+    std::remove(logPath.c_str());
+
+    SCE::storage::ResultsStore store;
+    if (!store.open(logPath))
+    {
+        std::cerr << "Can't create " << logPath << "\n";
+        return 2;
+    }
+
+    TestAppend(store);
+    TestIndexUpdate(store, logPath);
+    TestTopScores(store);
+    TestPercentiles(store);
+    TestSeedLookup(store);
+    TestReopen(store, logPath);
+
+    store.close();
+
+    if (b_isPassing)
+    {
+        std::remove(logPath.c_str());
+        std::remove(IndexPath(logPath, "score", 4).c_str());
+        std::remove(IndexPath(logPath, "seed", 4).c_str());
+    }
+
+    std::cout << (b_isPassing ? "PASSED" : "FAILED") << "\n";
+
+    return b_isPassing ? 0 : 1;
+}
+
+void Check(bool b_condition, const std::string& t_description)
+{
+    if (!b_condition)
+    {
+        std::cerr << "Failed: " << t_description << "\n";
+        b_isPassing = false;
+    }
+
+    return;
+}
+
+bool FileExists(const std::string& t_filePath)
+{
+    std::ifstream file(t_filePath);
+
+    return static_cast<bool>(file);
+}
+
+std::string IndexPath(const std::string& t_logPath, const char* t_indexType, int t_generation)
+{
+    return t_logPath + "." + t_indexType + "." + std::to_string(t_generation) + ".idx";
+}
+
+SCE::storage::GameResult MakeResult(int t_recordNumber, int t_score)
+{
+    SCE::storage::GameResult result = {};
+    result.seed = t_recordNumber % SEED_COUNT;
+    result.durationMs = t_recordNumber;
+    result.score = t_score;
+    result.lines = t_score / 100;
+    result.pieces = t_recordNumber;
+    result.engineVersion = 10000;
+
+    return result;
+}
+
+//********************************************************************************
+
+// Scores go 0 to 99 over and over, the log has to grow past its first capacity
+void TestAppend(SCE::storage::ResultsStore& t_store)
+{
+    bool b_isAppended = true;
+    for (int recordNumber = 0; recordNumber < FIRST_RECORDS; recordNumber++)
+    {
+        b_isAppended = b_isAppended && t_store.append(MakeResult(recordNumber, recordNumber % SCORE_COUNT));
+    }
+    Check(b_isAppended, "every record is appended");
+    Check(t_store.getRecordCount() == FIRST_RECORDS, "the log counts every record");
+
+    // Records on both sides of the growth keep what was appended
+    const int checkedRecords[] = { 0, INITIAL_CAPACITY - 1, INITIAL_CAPACITY, FIRST_RECORDS - 1 };
+    for (int recordNumber : checkedRecords)
+    {
+        SCE::storage::GameResult result;
+        Check(t_store.getRecord(recordNumber, result) && result.durationMs == recordNumber &&
+            result.score == recordNumber % SCORE_COUNT && result.seed == static_cast<std::uint64_t>(recordNumber % SEED_COUNT),
+            "record " + std::to_string(recordNumber) + " reads back as appended");
+    }
+
+    SCE::storage::GameResult result;
+    Check(!t_store.getRecord(FIRST_RECORDS, result), "no record past the last one");
+
+    // Nothing is indexed yet, so the queries see nothing
+    Check(t_store.getTopScores(1).empty(), "no top score before the first index");
+
+    return;
+}
+
+void TestIndexUpdate(SCE::storage::ResultsStore& t_store, const std::string& t_logPath)
+{
+    Check(t_store.updateIndex(), "the first index is built");
+    Check(FileExists(IndexPath(t_logPath, "score", 1)) && FileExists(IndexPath(t_logPath, "seed", 1)), "generation 1 is written");
+
+    std::vector<SCE::storage::GameResult> topScores = t_store.getTopScores(1);
+    Check(topScores.size() == 1 && topScores[0].score == SCORE_COUNT - 1, "the best score is indexed");
+
+    // Without new records there is nothing to publish
+    Check(t_store.updateIndex(), "an index without new records is kept");
+    Check(!FileExists(IndexPath(t_logPath, "score", 2)), "no generation without new records");
+
+    // A new best score only shows up once it is indexed, merged into the published entries
+    Check(t_store.append(MakeResult(FIRST_RECORDS, 1000)), "a new best score is appended");
+
+    topScores = t_store.getTopScores(1);
+    Check(topScores.size() == 1 && topScores[0].score == SCORE_COUNT - 1, "the new record is not indexed yet");
+
+    Check(t_store.updateIndex(), "the index is updated");
+    topScores = t_store.getTopScores(1);
+    Check(topScores.size() == 1 && topScores[0].score == 1000 && topScores[0].durationMs == FIRST_RECORDS,
+        "the new best score is indexed");
+
+    // The published generation replaces the old one on disk
+    Check(FileExists(IndexPath(t_logPath, "score", 2)) && FileExists(IndexPath(t_logPath, "seed", 2)), "generation 2 is written");
+    Check(!FileExists(IndexPath(t_logPath, "score", 1)) && !FileExists(IndexPath(t_logPath, "seed", 1)), "generation 1 is deleted");
+
+    return;
+}
+
+// Equal scores come in appending order
+void TestTopScores(SCE::storage::ResultsStore& t_store)
+{
+    std::vector<SCE::storage::GameResult> topScores = t_store.getTopScores(4);
+    Check(topScores.size() == 4, "the top 4 has 4 results");
+    if (topScores.size() == 4)
+    {
+        Check(topScores[0].durationMs == FIRST_RECORDS, "the best score comes first");
+        Check(topScores[1].score == SCORE_COUNT - 1 && topScores[1].durationMs == SCORE_COUNT - 1, "the first tied score comes second");
+        Check(topScores[2].score == SCORE_COUNT - 1 && topScores[2].durationMs == 2 * SCORE_COUNT - 1, "the second tied score comes third");
+        Check(topScores[3].score == SCORE_COUNT - 1 && topScores[3].durationMs == 3 * SCORE_COUNT - 1, "the third tied score comes fourth");
+    }
+
+    Check(t_store.getTopScores(0).empty(), "the top 0 is empty");
+    Check(t_store.getTopScores(FIRST_RECORDS + 10).size() == FIRST_RECORDS + 1, "the top N stops at the indexed records");
+
+    return;
+}
+
+// Nearest rank, the lowest score is the 0th percentile and the best one the 100th
+void TestPercentiles(SCE::storage::ResultsStore& t_store)
+{
+    int score = -1;
+    Check(t_store.getScoreAtPercentile(0.0, score) && score == 0, "the 0th percentile is the lowest score");
+    Check(t_store.getScoreAtPercentile(100.0, score) && score == 1000, "the 100th percentile is the best score");
+
+    // 4197 scores: 42 of each from 0 to 95, 41 of each from 96 to 99 and the 1000.
+    // Rank 2099 of them falls on the 49s
+    Check(t_store.getScoreAtPercentile(50.0, score) && score == 49, "the 50th percentile is the median score");
+
+    Check(!t_store.getScoreAtPercentile(-0.5, score), "no percentile below 0");
+    Check(!t_store.getScoreAtPercentile(100.5, score), "no percentile above 100");
+
+    return;
+}
+
+// Every result of a seed, in appending order
+void TestSeedLookup(SCE::storage::ResultsStore& t_store)
+{
+    constexpr int SEED = 3;
+
+    std::vector<SCE::storage::GameResult> seedResults = t_store.getResultsForSeed(SEED);
+
+    int expectedCount = 0;
+    for (int recordNumber = 0; recordNumber <= FIRST_RECORDS; recordNumber++)
+    {
+        expectedCount += (recordNumber % SEED_COUNT == SEED) ? 1 : 0;
+    }
+    Check(static_cast<int>(seedResults.size()) == expectedCount, "every result of the seed is found");
+
+    bool b_isInOrder = true;
+    for (std::size_t resultIndex = 0; resultIndex < seedResults.size(); resultIndex++)
+    {
+        b_isInOrder = b_isInOrder && seedResults[resultIndex].seed == SEED &&
+            seedResults[resultIndex].durationMs == static_cast<std::int64_t>(SEED + resultIndex * SEED_COUNT);
+    }
+    Check(b_isInOrder, "the results of the seed come in appending order");
+
+    Check(t_store.getResultsForSeed(SEED_COUNT).empty(), "an unknown seed has no results");
+
+    return;
+}
+
+// The published index is found again without rebuilding it, and readers follow newer generations
+void TestReopen(SCE::storage::ResultsStore& t_store, const std::string& t_logPath)
+{
+    t_store.close();
+    Check(t_store.open(t_logPath), "the log opens again");
+    Check(t_store.getRecordCount() == FIRST_RECORDS + 1, "the reopened log keeps every record");
+
+    std::vector<SCE::storage::GameResult> topScores = t_store.getTopScores(1);
+    Check(topScores.size() == 1 && topScores[0].score == 1000, "the reopened log keeps its index");
+
+    Check(t_store.append(MakeResult(FIRST_RECORDS + 1, 2000)), "a record is appended to the reopened log");
+    Check(t_store.updateIndex(), "the reopened index is updated");
+    Check(!FileExists(IndexPath(t_logPath, "score", 2)) && FileExists(IndexPath(t_logPath, "score", 3)), "generation 3 replaces generation 2");
+
+    // A second store keeps generation 3 mapped while the first one publishes generation 4
+    SCE::storage::ResultsStore reader;
+    Check(reader.open(t_logPath), "a second store opens the same log");
+    topScores = reader.getTopScores(1);
+    Check(topScores.size() == 1 && topScores[0].score == 2000, "the second store reads the published index");
+
+    Check(t_store.append(MakeResult(FIRST_RECORDS + 2, 3000)) && t_store.updateIndex(), "generation 4 is published");
+    Check(!FileExists(IndexPath(t_logPath, "score", 3)) && !FileExists(IndexPath(t_logPath, "seed", 3)),
+        "generation 3 is deleted while the second store still maps it");
+
+    topScores = reader.getTopScores(1);
+    Check(topScores.size() == 1 && topScores[0].score == 3000 && topScores[0].durationMs == FIRST_RECORDS + 2,
+        "the second store follows the new generation");
+
+    return;
+}